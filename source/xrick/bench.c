@@ -0,0 +1,256 @@
+/*
+ * xrick/bench.c
+ *
+ * Copyright (C) 2008-2014 Pierluigi Vicinanza. All rights reserved.
+ *
+ * The use and distribution terms for this software are contained in the file
+ * named README, which can be found in the root of this distribution. By
+ * using this software in any fashion, you are agreeing to be bound by the
+ * terms of this license.
+ *
+ * You must not remove this notice, or any other, from this software.
+ */
+
+#include "xrick/bench.h"
+
+#include "xrick/draw.h"
+#include "xrick/ents.h"
+#include "xrick/game.h"
+#include "xrick/maps.h"
+#include "xrick/replay.h"
+#include "xrick/system/system.h"
+
+#define BENCH_SPRITES_REPEAT 16  /* draws of the sprites of each frame */
+
+/*
+ * typedefs
+ */
+typedef struct
+{
+    U8 number;
+    U16 x, y;
+    bool front;
+} benchSprite_t;
+
+/*
+ * prototypes
+ */
+static void benchMaps(void);
+static void benchSprites(void);
+static U16 submapRows(U16);
+
+/*
+ * Load resources, run all micro-benchmarks, unload resources
+ */
+bool
+bench_run(void)
+{
+    if (!game_load())
+    {
+        return false;
+    }
+
+    benchMaps();
+    benchSprites();
+
+    game_unload();
+    return true;
+}
+
+/*
+ * map_expand: full expansion, as when a submap starts, against scrolling
+ * through submaps one row at a time, which expands one row per call.
+ * Scrolling by 8 rows used to cost a full expansion on top.
+ */
+static void
+benchMaps(void)
+{
+    U32 n, start;
+    U32 fullTime, rowTime = 0;
+    U32 rowCalls = 0;
+    U16 submap = 0;
+    U16 rows, last;
+
+    for (n = 0; n < map_nbr_submaps; n++)
+    {
+        if (submapRows(n) > MAP_ROWS)
+        {
+            break;
+        }
+    }
+    if (n == map_nbr_submaps)
+    {
+        sys_printf("xrick/bench: map_expand, no submap to scroll through\n");
+        return;
+    }
+
+    /* full expansions */
+    start = sys_gettimeUs();
+    for (n = 0; n < BENCH_LOOPS; n++)
+    {
+        do
+        {
+            submap = (submap + 1) % map_nbr_submaps;
+        }
+        while (submapRows(submap) <= MAP_ROWS);
+        game_submap = submap;
+        map_frow = 0;
+        game_ctx->maps.expanded = false;
+        map_expand();
+    }
+    fullTime = sys_gettimeUs() - start;
+
+    /* one row at a time, down to the bottom of each submap, then back up */
+    while (rowCalls < BENCH_LOOPS)
+    {
+        submap = (submap + 1) % map_nbr_submaps;
+        rows = submapRows(submap);
+        if (rows <= MAP_ROWS)
+        {
+            continue;
+        }
+        last = (rows - MAP_ROWS > 0xff) ? 0xff : rows - MAP_ROWS;  /* map_frow is a U8 */
+        game_submap = submap;
+        map_frow = 0;
+        game_ctx->maps.expanded = false;
+        map_expand();
+
+        start = sys_gettimeUs();
+        for (n = 0; n < 2 * (U32)last; n++)
+        {
+            if (n < last)
+            {
+                map_frow++;
+            }
+            else
+            {
+                map_frow--;
+            }
+            map_expand();
+        }
+        rowTime += sys_gettimeUs() - start;
+        rowCalls += n;
+    }
+
+    sys_printf("xrick/bench: map_expand %.3f us full, %.3f us one row,"
+               " scrolling 8 rows costs %.0f%% of a full expansion\n",
+               (double)fullTime / BENCH_LOOPS,
+               (double)rowTime / rowCalls,
+               100.0 * 8 * rowTime / rowCalls * BENCH_LOOPS / (fullTime ? fullTime : 1));
+}
+
+/*
+ * draw_sprite2 against draw_sprite2Generic, which tests every pixel, on
+ * the sprites of the frames of play of a replay: once the game has drawn
+ * a frame, its sprites are drawn again by both, in turn. Drawing the same
+ * sprites over does not change the frame buffer.
+ */
+static void
+benchSprites(void)
+{
+#ifdef ENABLE_REPLAY
+    benchSprite_t sprites[ENT_ENTSNUM];
+    U32 start, fastTime = 0, genericTime = 0;
+    U32 calls = 0, frames = 0;
+    U8 i, n, k;
+    bool inPlay, wasInPlay;
+
+    if (!sysarg_args_replay)
+    {
+        sys_printf("xrick/bench: draw_sprite2, no replay to take frames of play from\n");
+        return;
+    }
+
+    if (!game_init())
+    {
+        game_shutdown();
+        return;
+    }
+    inPlay = game_inPlay();
+    /* until the replay runs out of inputs, or --frames are done */
+    while (game_step() && replay_isPlaying())
+    {
+        /* from one frame of play to the next: the frame was drawn by play3 */
+        wasInPlay = inPlay;
+        inPlay = game_inPlay();
+        if (!wasInPlay || !inPlay)
+        {
+            continue;
+        }
+
+        /* same sprites as ent_draw */
+        n = 0;
+        for (i = 0; ent_ents[i].n != 0xff; i++)
+        {
+#ifdef ENABLE_CHEATS
+            if (ent_ents[i].n && (game_cheat3 || ent_ents[i].sprite))
+#else
+            if (ent_ents[i].n && ent_ents[i].sprite)
+#endif
+            {
+                sprites[n].number = ent_ents[i].sprite;
+                sprites[n].x = ent_ents[i].x;
+                sprites[n].y = ent_ents[i].y;
+                sprites[n].front = ent_ents[i].front;
+                n++;
+            }
+        }
+
+        start = sys_gettimeUs();
+        for (k = 0; k < BENCH_SPRITES_REPEAT; k++)
+        {
+            for (i = 0; i < n; i++)
+            {
+                draw_sprite2(sprites[i].number, sprites[i].x, sprites[i].y, sprites[i].front);
+            }
+        }
+        fastTime += sys_gettimeUs() - start;
+
+        start = sys_gettimeUs();
+        for (k = 0; k < BENCH_SPRITES_REPEAT; k++)
+        {
+            for (i = 0; i < n; i++)
+            {
+                draw_sprite2Generic(sprites[i].number, sprites[i].x, sprites[i].y, sprites[i].front);
+            }
+        }
+        genericTime += sys_gettimeUs() - start;
+
+        calls += n * BENCH_SPRITES_REPEAT;
+        frames++;
+    }
+    game_shutdown();
+
+    if (!calls)
+    {
+        sys_printf("xrick/bench: draw_sprite2, no frame of play in the replay\n");
+        return;
+    }
+    sys_printf("xrick/bench: draw_sprite2 %.3f us, generic %.3f us per sprite,"
+               " %.0f%% of generic, over %u frames of play\n",
+               (double)fastTime / calls,
+               (double)genericTime / calls,
+               100.0 * fastTime / (genericTime ? genericTime : 1),
+               frames);
+#else
+    sys_printf("xrick/bench: draw_sprite2, no replay support\n");
+#endif /* ENABLE_REPLAY */
+}
+
+/*
+ * Rows of tiles in a submap, from its first block to the next submap's
+ */
+static U16
+submapRows(U16 submap)
+{
+    size_t end = (submap + 1U < map_nbr_submaps) ?
+        map_submaps[submap + 1].bnum : map_nbr_bnums;
+
+    if (end <= map_submaps[submap].bnum)
+    {
+        return 0;
+    }
+    return (U16)((end - map_submaps[submap].bnum) / 8 * 4);
+}
+
+/* eof */
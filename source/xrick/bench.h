@@ -0,0 +1,30 @@
+/*
+ * xrick/bench.h
+ *
+ * Copyright (C) 2008-2014 Pierluigi Vicinanza. All rights reserved.
+ *
+ * The use and distribution terms for this software are contained in the file
+ * named README, which can be found in the root of this distribution. By
+ * using this software in any fashion, you are agreeing to be bound by the
+ * terms of this license.
+ *
+ * You must not remove this notice, or any other, from this software.
+ */
+
+#ifndef _BENCH_H
+#define _BENCH_H
+
+#include "xrick/system/basic_types.h"
+
+/*
+ * Micro-benchmarks, run by xrick-headless --bench: each one times a piece
+ * of drawing or map code in a loop, out of any game, and reports the
+ * average cost per call.
+ */
+#define BENCH_LOOPS 20000  /* calls per measure */
+
+extern bool bench_run(void);
+
+#endif /* ndef _BENCH_H */
+
+/* eof */
@@ -0,0 +1,97 @@
+/*
+ * xrick/config.h
+ *
+ * Copyright (C) 1998-2002 BigOrno (bigorno@bigorno.net).
+ * Copyright (C) 2008-2014 Pierluigi Vicinanza.
+ * All rights reserved.
+ *
+ * The use and distribution terms for this software are contained in the file
+ * named README, which can be found in the root of this distribution. By
+ * using this software in any fashion, you are agreeing to be bound by the
+ * terms of this license.
+ *
+ * You must not remove this notice, or any other, from this software.
+ */
+
+#ifndef XRICK_CONFIG_H
+#define XRICK_CONFIG_H
+
+/* version */
+#define XRICK_VERSION_STR "2.0.0"
+
+/* graphics (choose one) */
+#define GFXST
+/* #undef GFXPC */
+
+/* joystick support */
+/* #undef ENABLE_JOYSTICK */
+
+/* sound support */
+#define ENABLE_SOUND
+
+/* cheats support */
+#define ENABLE_CHEATS
+
+/* auto-defocus support */
+/* does seem to cause all sorts of problems on BeOS, Windows... */
+/* #undef ENABLE_FOCUS */
+
+/* development tools */
+/* #undef ENABLE_DEVTOOLS */
+
+/* inputs recording and replay */
+#define ENABLE_REPLAY
+
+/* rewind, i.e. stepping back through the last frames of play */
+#define ENABLE_REWIND
+
+/* decoded tiles cache, of TILES_CACHE_SLOTS tiles per game (least recently
+ * used tiles go first), or of all tiles, shared, when TILES_CACHE_SLOTS is 0 */
+#define ENABLE_TILES_CACHE
+#define TILES_CACHE_SLOTS 0
+
+/* decoded sprites cache, shared (GFXST), or pre-shifted sprites cache of
+ * SPRITES_CACHE_BUDGET KiB per game (GFXPC, least recently used go first) */
+#define ENABLE_SPRITES_CACHE
+#define SPRITES_CACHE_BUDGET 32
+
+/* save-under buffers: entities are erased by putting back what was under
+ * their sprites, instead of redrawing the map */
+#define ENABLE_SAVE_UNDER
+
+/* map layer: a copy of the map screen background, drawn along with the map,
+ * that entities and the status bar are erased from instead of redrawing tiles */
+#define ENABLE_MAP_LAYER
+
+/* cost of a screen update call, in pixels copied: screen rectangles merge
+ * when copying a few more pixels is cheaper than one more call */
+#define RECTS_CALL_COST 1024
+
+/* frame timing profiler */
+#define ENABLE_PROFILER
+
+/* parallel game instances (headless only) */
+#define ENABLE_THREADS
+
+/* frames presented by a separate thread, from a second frame buffer (SDL only) */
+#define ENABLE_PRESENTER
+
+/* enable/disable subsystem debug */
+/* #undef DEBUG_MEMORY */
+/* #undef DEBUG_ENTS */
+/* #undef DEBUG_SCROLLER */
+/* #undef DEBUG_MAPS */
+/* #undef DEBUG_JOYSTICK */
+/* #undef DEBUG_EVENTS */
+/* #undef DEBUG_AUDIO */
+/* #undef DEBUG_AUDIO2 */
+/* #undef DEBUG_VIDEO */
+/* #undef DEBUG_VIDEO2 */
+
+/* compressed archive support*/
+#define ENABLE_ZIP
+
+#endif /* ndef XRICK_CONFIG_H */
+
+/* eof */
+
@@ -0,0 +1,65 @@
+/*
+ * xrick/context.c
+ *
+ * Copyright (C) 2008-2014 Pierluigi Vicinanza. All rights reserved.
+ *
+ * The use and distribution terms for this software are contained in the file
+ * named README, which can be found in the root of this distribution. By
+ * using this software in any fashion, you are agreeing to be bound by the
+ * terms of this license.
+ *
+ * You must not remove this notice, or any other, from this software.
+ */
+
+#include "xrick/context.h"
+
+#include "xrick/game.h"
+#include "xrick/draw.h"
+
+#include <string.h> /* memset */
+
+/*
+ * global vars
+ */
+game_context_t game_defaultContext;
+THREAD_LOCAL game_context_t *game_ctx = &game_defaultContext;
+
+/*
+ * Reset game state to its initial values
+ *
+ * The frame buffer, draw buffers, entity marks and high scores belong to
+ * whoever set the context up, they are kept as is.
+ */
+void
+context_init(game_context_t *ctx)
+{
+    U8 *fb = ctx->fb;
+    U8 *drawBuffers = ctx->drawBuffers.block;
+    mark_t *marks = ctx->maps.marks;
+    hiscore_t *highScores = ctx->screens.highScores;
+    U8 i;
+
+    memset(ctx, 0, sizeof(*ctx));
+
+    ctx->fb = fb;
+    ctx->drawBuffers.block = drawBuffers;
+    ctx->maps.marks = marks;
+    ctx->screens.highScores = highScores;
+
+    ctx->game.dir = RIGHT;
+    ctx->control.active = true;
+
+    ctx->draw.statusRect.x = DRAW_STATUS_SCORE_X;
+    ctx->draw.statusRect.y = DRAW_STATUS_Y;
+    ctx->draw.statusRect.width = DRAW_STATUS_LIVES_X + 6 * 8 - DRAW_STATUS_SCORE_X;
+    ctx->draw.statusRect.height = 8;
+    for (i = 0; i < 6; ++i)
+    {
+        ctx->draw.status[i] = 0x30;
+    }
+    ctx->draw.status[6] = 0xfe;
+
+    ctx->screens.imain.first = true;
+}
+
+/* eof */
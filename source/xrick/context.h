@@ -0,0 +1,366 @@
+/*
+ * xrick/context.h
+ *
+ * Copyright (C) 2008-2014 Pierluigi Vicinanza. All rights reserved.
+ *
+ * The use and distribution terms for this software are contained in the file
+ * named README, which can be found in the root of this distribution. By
+ * using this software in any fashion, you are agreeing to be bound by the
+ * terms of this license.
+ *
+ * You must not remove this notice, or any other, from this software.
+ */
+
+#ifndef _CONTEXT_H
+#define _CONTEXT_H
+
+#include "xrick/config.h"
+#include "xrick/system/basic_types.h"
+#include "xrick/system/system.h"
+#include "xrick/rects.h"
+#include "xrick/ents.h"
+#include "xrick/maps.h"
+#include "xrick/screens.h"
+#ifdef ENABLE_SOUND
+#include "xrick/data/sounds.h"
+#endif
+#ifdef ENABLE_REPLAY
+#include "xrick/replay.h"
+#endif
+
+/*
+ * Every piece of mutable game state lives in a context, so that several
+ * games can run side by side, one context per game. Module headers map
+ * their public variables onto the current context (e.g. ent_ents is
+ * game_ctx->ents.ents), private ones are accessed through game_ctx.
+ *
+ * Resources (sprites, tiles, maps...) are read-only once loaded, and
+ * shared by all contexts. Entity marks and high scores are written to
+ * while playing: each context has its own copy.
+ *
+ * game_ctx is thread local: a thread runs the game of the context it
+ * points to. It defaults to game_defaultContext.
+ */
+#ifdef ENABLE_THREADS
+#ifdef _MSC_VER
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
+#endif
+#else
+#define THREAD_LOCAL
+#endif /* ENABLE_THREADS */
+
+#if (defined(ENABLE_TILES_CACHE) && TILES_CACHE_SLOTS) || \
+    (defined(GFXPC) && defined(ENABLE_SPRITES_CACHE))
+typedef struct
+{
+    U16 key;         /* cached tile or sprite, see draw.c */
+    U16 prev, next;  /* least recently used list */
+} context_cacheSlot_t;
+#endif
+
+typedef struct
+{
+    U8 *fb;  /* frame buffer */
+
+    struct
+    {
+        U8 *block;    /* draw_buffersSize() bytes, see draw.c */
+        bool pushed;  /* taken from sysmem by draw_init() */
+    } drawBuffers;
+
+    struct
+    {
+        U8 period;
+        U32 time;
+        U32 frames;
+        bool waitevt;
+        const rect_t *rects;
+        U8 lives;
+        U8 bombs;
+        U8 bullets;
+        U32 score;
+        U16 map;
+        U16 submap;
+        U8 dir;
+        bool chsm;
+        bool cheat1;
+        bool cheat2;
+        bool cheat3;
+        U8 state;       /* see game.c */
+        U8 frameState;  /* state that produced the frame */
+        U8 isaveFrow;
+#ifdef ENABLE_SOUND
+        sound_t *music;         /* current music */
+#endif
+    } game;
+
+    struct
+    {
+        unsigned status;
+        bool active;
+    } control;
+
+    struct
+    {
+        bool turbo;     /* turbo was on for the previous frame */
+        bool late;      /* behind schedule, do not display next frame */
+        bool skip;      /* current tick is not displayed */
+        U8 run;         /* frames not displayed in a row, when late */
+        U32 lateFrames; /* statistics */
+        U32 turboTicks;
+    } frameskip;
+
+    struct
+    {
+        U8 *tllst;
+#ifdef GFXPC
+        U16 filter;
+#endif
+        U8 tilesBank;
+        rect_t statusRect;
+        U8 *fb;         /* frame buffer pointer */
+        U8 status[7];   /* status bar tiles list */
+    } draw;
+
+#if defined(ENABLE_TILES_CACHE) && TILES_CACHE_SLOTS
+    struct
+    {
+        U8 *tiles;             /* TILES_CACHE_SLOTS decoded tiles */
+        context_cacheSlot_t *slots;
+        U16 *index;            /* tile key to slot number + 1, 0 if not cached */
+        U16 head;              /* most recently used slot */
+    } tilesCache;
+#endif
+
+#if defined(GFXPC) && defined(ENABLE_SPRITES_CACHE)
+    struct
+    {
+        U8 *sprites;           /* nbrSlots pre-shifted sprites */
+        context_cacheSlot_t *slots;
+        U16 *index;            /* sprite key to slot number + 1, 0 if not cached */
+        U16 head;              /* most recently used slot */
+        U16 nbrSlots;
+        U32 hits, misses;
+    } spritesCache;
+#endif
+
+#ifdef ENABLE_SAVE_UNDER
+    struct
+    {
+        U8 *pixels;                 /* what was under sprites, see draw.c */
+        rect_t rects[ENT_ENTSNUM];  /* where, per entity (pixels, screen) */
+        U16 redraw;                 /* entities to erase by redrawing the map */
+        bool valid;                 /* map not redrawn since sprites were saved */
+    } saveUnder;
+#endif
+
+#ifdef ENABLE_MAP_LAYER
+    struct
+    {
+        U8 *pixels;            /* map screen background, see draw.c */
+        U8 *status;            /* status bar background */
+        U16 top;               /* layer row at the top of the map screen */
+        bool valid;            /* map screen not redrawn since */
+#ifdef GFXPC
+        U16 filter;            /* what the layer was drawn with */
+#endif
+        U8 tilesBank;
+        U32 rebuilds, scrolls; /* statistics */
+    } mapLayer;
+#endif
+
+    struct
+    {
+        bool lethal;
+        U8 ticker;
+        U8 xc;
+        U16 yc;
+    } e_bomb;
+
+    struct
+    {
+        S8 offsx;
+        S16 xc;
+        S16 yc;
+    } e_bullet;
+
+    struct
+    {
+        S16 stopX;
+        S16 stopY;
+        unsigned state;
+        U8 scrawl;
+        bool trigger;
+        S8 offsx;
+        U8 ylow;
+        S16 offsy;
+        U8 seq;
+        U8 saveCrawl;
+        U8 saveDirection;
+        U16 saveX;
+        U16 saveY;
+        bool stopped;
+    } e_rick;
+
+    struct
+    {
+        bool counting;
+        U8 counter;
+        U16 bonus;
+    } e_sbonus;
+
+    /* order matters: e_them_t2_action2 reads past rndseed */
+    struct
+    {
+        U32 rndseed;
+        U16 cx;
+        U16 bx;
+        U16 rndnbr;
+    } e_them;
+
+    struct
+    {
+        ent_t ents[ENT_ENTSNUM + 1];
+        bool ch3;
+    } ents;
+
+    struct
+    {
+        U8 map[MAP_ROWS * MAP_COLS];  /* ring of rows, see maps.h */
+        U8 eflg[0x100];
+        U32 fgnd[MAP_ROWS];    /* foreground tiles of map, see maps.h */
+        U8 ring;
+        U8 frow;
+        bool expanded;         /* map holds expandedSubmap from expandedFrow */
+        U16 expandedSubmap;
+        U8 expandedFrow;
+        U8 tilesBank;
+        mark_t *marks;
+    } maps;
+
+    struct
+    {
+        U32 dirty[RECTS_ROWS][RECTS_WORDS];  /* tiles to refresh, see rects.h */
+        rect_t spans[RECTS_MAX_SPANS];
+        U32 frames;            /* statistics */
+        U32 rectsIn;
+        U32 rectsOut;
+        double pixelsIn;
+        double pixelsOut;
+    } rects;
+
+    struct
+    {
+        hiscore_t *highScores;
+        struct
+        {
+            U8 seq;
+            U8 wait;
+        } xrick;
+        struct
+        {
+            U8 seq;
+            U8 seen;
+            bool first;
+            U8 period;
+            U32 tm;
+        } imain;
+        struct
+        {
+            U16 step;              /* current step */
+            U16 count;             /* number of loops for current step */
+            U16 run;               /* 1 = run, 0 = no more step */
+            U8 flipflop;           /* flipflop for top, bottom, left, right */
+            U8 spnum;              /* sprite number */
+            U16 spx, spdx;         /* sprite x position and delta */
+            U16 spy, spdy;         /* sprite y position and delta */
+            U16 spbase, spoffs;    /* base, offset for sprite numbers table */
+            U8 seq;                /* anim sequence */
+        } imap;
+        struct
+        {
+            U8 seq;
+            U8 period;
+            U32 tm;
+        } gameover;
+        struct
+        {
+            U8 seq;
+            U8 x, y, p;
+            U8 name[HISCORE_NAME_SIZE];
+            U32 tm;
+        } getname;
+    } screens;
+
+    struct
+    {
+        U8 period;
+        U8 nUp;
+        U8 nDown;
+    } scroller;
+
+#ifdef ENABLE_DEVTOOLS
+    struct
+    {
+        U8 seq;
+        U8 pos;
+        U8 pos2;
+    } devtools;
+#endif
+
+#ifdef ENABLE_REPLAY
+    struct
+    {
+        U8 mode;
+        bool stopped;          /* buffer full, or end of stream */
+        file_t file;
+        U8 *buffer;            /* stream and keyframes table, plus snapshot when recording */
+        U8 *snapshot;          /* keyframe snapshot, when recording */
+        U8 *stream;
+        replay_keyframe_t *keyframes;
+        U32 streamSize;        /* in bytes */
+        U32 keyframesCount;
+        U32 nextKeyframe;      /* first frame the next keyframe can be taken on */
+        U32 snapshotSize;      /* keyframe snapshot size, in bytes */
+        U32 framesCount;       /* frames covered by the stream */
+        U32 frame;             /* current frame */
+        U32 offset;            /* current offset in the stream */
+        U32 seed;              /* e_them_rndseed, as of last frame */
+        U32 runLength;         /* frames in (recording) or left in (playback) current run */
+        U32 runInputs;
+        U32 runDelta;
+        bool desync;
+    } replay;
+#endif
+
+#ifdef ENABLE_REWIND
+    struct
+    {
+        U8 *buffer;            /* entries ring */
+        U32 size;              /* in bytes */
+        U32 head;              /* where the next entry goes */
+        U32 tail;              /* oldest entry */
+        U32 used;              /* in bytes */
+        U32 entries;
+        U32 sinceKey;          /* entries since the last keyframe */
+        U8 *key;               /* last keyframe, decoded */
+        U8 *scratch;           /* state being encoded or decoded */
+        U32 pushedFrames;      /* statistics */
+        U32 pushedBytes;
+        U32 steps;
+        U32 maxLatency;        /* in microseconds */
+        double sumLatency;
+    } rewind;
+#endif
+} game_context_t;
+
+extern game_context_t game_defaultContext;
+extern THREAD_LOCAL game_context_t *game_ctx;
+
+extern void context_init(game_context_t *);
+
+#endif /* ndef _CONTEXT_H */
+
+/* eof */
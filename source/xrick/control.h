@@ -17,6 +17,7 @@
 #define _CONTROL_H
 
 #include "xrick/system/basic_types.h"
+#include "xrick/context.h"
 
 typedef enum
 {
@@ -27,14 +28,16 @@ typedef enum
     Control_PAUSE = (1 << 4),
     Control_END = (1 << 5),
     Control_EXIT = (1 << 6),
-    Control_FIRE = (1 << 7)
+    Control_FIRE = (1 << 7),
+    Control_REWIND = (1 << 8),
+    Control_TURBO = (1 << 9)
 } control_t;
 
-extern unsigned control_status;
+#define control_status (game_ctx->control.status)
 inline bool control_test(control_t c) { return control_status & c; }
 inline void control_set(control_t c) { control_status |= c; }
 inline void control_clear(control_t c) { control_status &= ~c; }
-extern bool control_active;
+#define control_active (game_ctx->control.active)
 
 #endif /* ndef _CONTROL_H */
 
@@ -55,50 +55,152 @@
 
 #include "xrick/maps.h"
 #include "xrick/rects.h"
+#include "xrick/profiler.h"
 #include "xrick/data/img.h"
 
+#include <string.h> /* memcpy, memset */
+#if defined(GFXST) && defined(ENABLE_SPRITES_CACHE)
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+#endif
+
+
+/*
+ * public vars
+ */
+const rect_t draw_SCREENRECT = { 0, 0, SYSVID_WIDTH, SYSVID_HEIGHT, NULL };
+
+size_t game_color_count = 0;
+img_color_t *game_colors = NULL;
 
 /*
- * counters positions (pixels, screen)
+ * Decoded tiles cache
+ *
+ * Tiles are stored 2 (GFXPC) or 4 (GFXST) bits per pixel. The cache holds
+ * them decoded, one byte per pixel, so that drawing a tile is copying 8
+ * rows of 8 bytes. GFXPC tiles are cached once per CGA filter (0xffff,
+ * 0xaaaa and 0x5555), other filters are not cached.
+ *
+ * A tile key is (filter * tiles_nbr_banks + bank) * TILES_NBR_TILES + tile.
+ *
+ * When TILES_CACHE_SLOTS is 0, all tiles are decoded once when loading,
+ * and shared by all games. Otherwise each game decodes tiles on demand into
+ * TILES_CACHE_SLOTS slots, the least recently used tile making room.
  */
+#ifdef ENABLE_TILES_CACHE
+#define TILES_CACHE_TILESIZE (8 * TILES_NBR_LINES)
 #ifdef GFXPC
-#define DRAW_STATUS_SCORE_X 0x28
-#define DRAW_STATUS_LIVES_X 0xE8
-#define DRAW_STATUS_Y 0x08
+#define TILES_CACHE_FILTERS 3
 #endif
-#define DRAW_STATUS_BULLETS_X 0x68
-#define DRAW_STATUS_BOMBS_X 0xA8
 #ifdef GFXST
-#define DRAW_STATUS_SCORE_X 0x20
-#define DRAW_STATUS_LIVES_X 0xF0
-#define DRAW_STATUS_Y 0
+#define TILES_CACHE_FILTERS 1
+#endif
+#define TILES_CACHE_KEYS (TILES_CACHE_FILTERS * tiles_nbr_banks * TILES_NBR_TILES)
+
+#if !TILES_CACHE_SLOTS
+static U8 *tilesCache = NULL;
 #endif
 
+static void tilesCache_decode(U8 *, U16);
+static const U8 *tilesCache_get(U8);
+#endif /* ENABLE_TILES_CACHE */
 
 /*
- * public vars
+ * Decoded sprites cache (GFXST)
+ *
+ * Sprites are stored 4 bits per pixel, colour 0 being transparent. The
+ * cache holds them decoded, one byte per pixel, rows of 32 pixels aligned
+ * on 16 bytes, so that draw_sprite2 blends whole rows instead of pixels.
+ * The opacity mask is not stored: it is one compare away from the colours.
  */
-U8 *draw_tllst;    /* pointer to tiles list */
-#ifdef GFXPC
-U16 draw_filter;   /* CGA colors filter */
-#endif
-U8 draw_tilesBank; /* tile number offset */
+#if defined(GFXST) && defined(ENABLE_SPRITES_CACHE)
+#define SPRITES_CACHE_WIDTH (SPRITES_NBR_COLS * 8)
+#define SPRITES_CACHE_SIZE (SPRITES_CACHE_WIDTH * SPRITES_NBR_ROWS)
+#define SPRITES_CACHE_ALIGN 16
+#define SPRITES_CACHE_MROWS 4  /* map rows a sprite covers, at most */
 
-rect_t draw_STATUSRECT = {
-  DRAW_STATUS_SCORE_X, DRAW_STATUS_Y,
-  DRAW_STATUS_LIVES_X + 6 * 8 - DRAW_STATUS_SCORE_X, 8,
-  NULL
-};
-const rect_t draw_SCREENRECT = { 0, 0, SYSVID_WIDTH, SYSVID_HEIGHT, NULL };
+static U8 *spritesCacheBlock = NULL;  /* as allocated */
+static U8 *spritesCache = NULL;       /* aligned */
 
-size_t game_color_count = 0;
-img_color_t *game_colors = NULL;
+static U32 spritesCache_visible(U16, U8, U32);
+static void spritesCache_blend(U8 *, const U8 *, const U8 *, bool);
+#endif /* GFXST && ENABLE_SPRITES_CACHE */
+
+/*
+ * Pre-shifted sprites cache (GFXPC)
+ *
+ * Sprites are stored 2 bits per pixel, a mask and a picture per tile
+ * column, and drawn shifted right by 0 to 7 pixels within tile columns.
+ * The cache holds them shifted and decoded, one byte per pixel, so that
+ * drawing a sprite is and-ing then or-ing rows of bytes. Each row is 32
+ * mask bytes then 32 picture bytes: as draw_sprite2Generic, the pixels
+ * shifted past the fourth tile column are not drawn.
+ *
+ * A sprite key is sprite * 8 + shift. Each game shifts sprites on demand,
+ * into as many slots as SPRITES_CACHE_BUDGET KiB hold, the least recently
+ * used sprite making room.
+ */
+#if defined(GFXPC) && defined(ENABLE_SPRITES_CACHE)
+#define SPRITES_CACHE_WIDTH (SPRITES_NBR_COLS * 8)
+#define SPRITES_CACHE_SIZE (2 * SPRITES_CACHE_WIDTH * SPRITES_NBR_ROWS)
+
+static void spritesCache_shift(U8 *, U16);
+static const U8 *spritesCache_get(U8, U8);
+static void spritesCache_blit(const U8 *, S16, S16, U16, U16, bool, bool);
+#endif /* GFXPC && ENABLE_SPRITES_CACHE */
+
+/*
+ * Save-under buffers
+ *
+ * Before an entity's sprite is drawn, the pixels it is about to cover are
+ * saved, one slot per entity, rows of 32 pixels. Entities are then erased
+ * by putting those pixels back, rather than by redrawing the map behind
+ * them, until the map is redrawn or scrolled.
+ */
+#ifdef ENABLE_SAVE_UNDER
+#define DRAW_SAVEUNDER_WIDTH (SPRITES_NBR_COLS * 8)
+#define DRAW_SAVEUNDER_SIZE (DRAW_SAVEUNDER_WIDTH * SPRITES_NBR_ROWS)
+#endif
 
 /*
- * private vars
+ * Map layer
+ *
+ * A copy of the map screen background, taken when the map is drawn and
+ * kept up to date when it scrolls, along with what draw_clearStatus draws
+ * the status bar with. Redrawing the map behind a sprite, or clearing the
+ * status bar, is then copying rows of pixels rather than drawing tiles.
+ * The layer is only used with the tiles bank and filter it was drawn with.
+ *
+ * Layer rows are a ring: scrolling moves the top row of the map screen
+ * along, and only the row of tiles coming into view is copied.
  */
-static U8 *fb;     /* frame buffer pointer */
+#ifdef ENABLE_MAP_LAYER
+#define DRAW_MAPLAYER_WIDTH (0x20 * 8)
+#define DRAW_MAPLAYER_HEIGHT (0x18 * 8)
+#ifdef GFXPC
+#define DRAW_MAPLAYER_TOP 0  /* map screen first row (pixels, screen) */
+#endif
+#ifdef GFXST
+#define DRAW_MAPLAYER_TOP 8
+#endif
+
+static void mapLayer_drawStatus(void);
+static bool mapLayer_usable(void);
+static U8 *mapLayer_row(U16);
+static void mapLayer_save(U16, U16);
+static void mapLayer_restore(U16, U16, U16, U16);
+#endif
+
+static void draw_statusBackground(void);
 
+#if (defined(ENABLE_TILES_CACHE) && TILES_CACHE_SLOTS) || \
+    (defined(GFXPC) && defined(ENABLE_SPRITES_CACHE))
+static void lruCache_init(context_cacheSlot_t *, U16, U16 *, U16, U16 *);
+static U16 lruCache_slot(context_cacheSlot_t *, U16 *, U16 *, U16, bool *);
+#endif
 
 /*
  * Set the frame buffer pointer
@@ -108,7 +210,7 @@ static U8 *fb;     /* frame buffer pointer */
 void
 draw_setfb(U16 x, U16 y)
 {
-  fb = sysvid_fb + x + y * SYSVID_WIDTH;
+  game_ctx->draw.fb = sysvid_fb + x + y * SYSVID_WIDTH;
 }
 
 
@@ -172,10 +274,10 @@ draw_tilesList(void)
 {
   U8 *t;
 
-  t = fb;
+  t = game_ctx->draw.fb;
   while (draw_tilesSubList() != 0xFE) {  /* draw sub-list */
     t += 8 * SYSVID_WIDTH;  /* go down one tile i.e. 8 lines */
-    fb = t;
+    game_ctx->draw.fb = t;
   }
 }
 
@@ -240,7 +342,22 @@ draw_tile(U8 tileNumber)
   U32 x;
 #endif
 
-  f = fb;  /* frame buffer */
+  f = game_ctx->draw.fb;  /* frame buffer */
+
+#ifdef ENABLE_TILES_CACHE
+  {
+    const U8 *t = tilesCache_get(tileNumber);
+    if (t) {
+      for (i = 0; i < TILES_NBR_LINES; i++) {  /* for all 8 pixel lines */
+        memcpy(f, t, 8);
+        t += 8;
+        f += SYSVID_WIDTH;  /* next line */
+      }
+      game_ctx->draw.fb += 8;  /* next tile */
+      return;
+    }
+  }
+#endif /* ENABLE_TILES_CACHE */
   for (i = 0; i < TILES_NBR_LINES; i++) {  /* for all 8 pixel lines */
 
 #ifdef GFXPC
@@ -267,7 +384,360 @@ draw_tile(U8 tileNumber)
 
   }
 
-  fb += 8;  /* next tile */
+  game_ctx->draw.fb += 8;  /* next tile */
+}
+
+#ifdef ENABLE_TILES_CACHE
+/*
+ * Decode a tile, by key, into 8 rows of 8 bytes
+ */
+static void
+tilesCache_decode(U8 *t, U16 key)
+{
+    U16 tile = key % (tiles_nbr_banks * TILES_NBR_TILES);
+    U8 i, k;
+#ifdef GFXPC
+    static const U16 filters[TILES_CACHE_FILTERS] = { 0xffff, 0xaaaa, 0x5555 };
+    U16 filter = filters[key / (tiles_nbr_banks * TILES_NBR_TILES)];
+    U16 x;
+#endif
+#ifdef GFXST
+    U32 x;
+#endif
+
+    for (i = 0; i < TILES_NBR_LINES; i++, t += 8)
+    {
+#ifdef GFXPC
+        x = tiles_data[tile][i] & filter;
+        for (k = 8; k--; x >>= 2)
+        {
+            t[k] = x & 3;
+        }
+#endif
+#ifdef GFXST
+        x = tiles_data[tile][i];
+        for (k = 8; k--; x >>= 4)
+        {
+            t[k] = x & 0x0F;
+        }
+#endif
+    }
+}
+
+/*
+ * Return the decoded tile of the current bank (and filter), or NULL if
+ * it can not be cached
+ */
+static const U8 *
+tilesCache_get(U8 tileNumber)
+{
+    U16 key = draw_tilesBank * TILES_NBR_TILES + tileNumber;
+#if TILES_CACHE_SLOTS
+    U16 slot;
+    bool fill;
+#endif
+
+#ifdef GFXPC
+    switch (draw_filter)
+    {
+        case 0xffff: break;
+        case 0xaaaa: key += 1 * tiles_nbr_banks * TILES_NBR_TILES; break;
+        case 0x5555: key += 2 * tiles_nbr_banks * TILES_NBR_TILES; break;
+        default: return NULL;
+    }
+#endif
+
+#if !TILES_CACHE_SLOTS
+    return tilesCache + key * TILES_CACHE_TILESIZE;
+#else
+    if (!game_ctx->tilesCache.slots)
+    {
+        return NULL;
+    }
+    slot = lruCache_slot(game_ctx->tilesCache.slots, game_ctx->tilesCache.index,
+                         &game_ctx->tilesCache.head, key, &fill);
+    if (fill)
+    {
+        tilesCache_decode(game_ctx->tilesCache.tiles + slot * TILES_CACHE_TILESIZE, key);
+    }
+    return game_ctx->tilesCache.tiles + slot * TILES_CACHE_TILESIZE;
+#endif /* TILES_CACHE_SLOTS */
+}
+#endif /* ENABLE_TILES_CACHE */
+
+#if (defined(ENABLE_TILES_CACHE) && TILES_CACHE_SLOTS) || \
+    (defined(GFXPC) && defined(ENABLE_SPRITES_CACHE))
+/*
+ * Empty a least recently used cache: all slots free, in a circular list
+ */
+static void
+lruCache_init(context_cacheSlot_t *slots, U16 nbrSlots, U16 *index, U16 nbrKeys, U16 *head)
+{
+    U16 i;
+
+    for (i = 0; i < nbrSlots; i++)
+    {
+        slots[i].key = 0xffff;
+        slots[i].prev = (i + nbrSlots - 1) % nbrSlots;
+        slots[i].next = (i + 1) % nbrSlots;
+    }
+    *head = 0;
+    memset(index, 0, nbrKeys * sizeof(U16));
+}
+
+/*
+ * Return the slot of a key in a least recently used cache, now the most
+ * recently used slot. On a miss the least recently used slot, i.e. the
+ * tail, is taken over: fill is set, the slot must be filled.
+ *
+ * slots: circular list, head first
+ * index: key to slot number + 1, 0 if not cached, CHANGED
+ * head: most recently used slot, CHANGED
+ */
+static U16
+lruCache_slot(context_cacheSlot_t *slots, U16 *index, U16 *head, U16 key, bool *fill)
+{
+    U16 slot = index[key];
+
+    *fill = !slot;
+    if (slot)
+    {
+        slot--;
+    }
+    else
+    {
+        slot = slots[*head].prev;
+        if (slots[slot].key != 0xffff)
+        {
+            index[slots[slot].key] = 0;
+        }
+        slots[slot].key = key;
+        index[key] = slot + 1;
+    }
+    if (slot == *head)
+    {
+        return slot;
+    }
+
+    /* move slot to the head of the list */
+    slots[slots[slot].prev].next = slots[slot].next;
+    slots[slots[slot].next].prev = slots[slot].prev;
+    slots[slot].next = *head;
+    slots[slot].prev = slots[*head].prev;
+    slots[slots[slot].prev].next = slot;
+    slots[*head].prev = slot;
+    *head = slot;
+    return slot;
+}
+#endif
+
+/*
+ * Decode tiles shared by all games, if they are all cached, and sprites
+ *
+ * Tiles and sprites must be loaded.
+ */
+bool
+draw_load(void)
+{
+#if defined(ENABLE_TILES_CACHE) && !TILES_CACHE_SLOTS
+    U16 key;
+
+    tilesCache = sysmem_push(TILES_CACHE_KEYS * TILES_CACHE_TILESIZE);
+    if (!tilesCache)
+    {
+        return false;
+    }
+    for (key = 0; key < TILES_CACHE_KEYS; key++)
+    {
+        tilesCache_decode(tilesCache + key * TILES_CACHE_TILESIZE, key);
+    }
+#endif
+#if defined(GFXST) && defined(ENABLE_SPRITES_CACHE)
+    {
+        size_t n;
+        U8 i, k, *p;
+        U32 d;
+
+        spritesCacheBlock = sysmem_push(sprites_nbr_sprites * SPRITES_CACHE_SIZE +
+                                        SPRITES_CACHE_ALIGN - 1);
+        if (!spritesCacheBlock)
+        {
+            return false;
+        }
+        spritesCache = (U8 *)(((uintptr_t)spritesCacheBlock + SPRITES_CACHE_ALIGN - 1) &
+                              ~(uintptr_t)(SPRITES_CACHE_ALIGN - 1));
+
+        /* 8 pixels per word, leftmost pixel in the high nibble */
+        p = spritesCache;
+        for (n = 0; n < sprites_nbr_sprites; n++)
+        {
+            for (i = 0; i < SPRITES_NBR_DATA; i++)
+            {
+                d = sprites_data[n][i];
+                for (k = 8; k--; d >>= 4)
+                {
+                    p[k] = d & 0x0F;
+                }
+                p += 8;
+            }
+        }
+    }
+#endif
+    return true;
+}
+
+void
+draw_unload(void)
+{
+#if defined(GFXST) && defined(ENABLE_SPRITES_CACHE)
+    sysmem_pop(spritesCacheBlock);
+    spritesCacheBlock = NULL;
+    spritesCache = NULL;
+#endif
+#if defined(ENABLE_TILES_CACHE) && !TILES_CACHE_SLOTS
+    sysmem_pop(tilesCache);
+    tilesCache = NULL;
+#endif
+}
+
+/*
+ * Size of the draw buffers of a game: save-under buffers and map layer
+ *
+ * Whoever sets a context up may provide them (drawBuffers.block), e.g. one
+ * block per instance along with its frame buffer. Otherwise draw_init()
+ * takes them from sysmem.
+ */
+size_t
+draw_buffersSize(void)
+{
+    size_t size = 0;
+
+#ifdef ENABLE_SAVE_UNDER
+    size += ENT_ENTSNUM * DRAW_SAVEUNDER_SIZE;
+#endif
+#ifdef ENABLE_MAP_LAYER
+    size += DRAW_MAPLAYER_WIDTH * DRAW_MAPLAYER_HEIGHT + 8 * SYSVID_WIDTH;
+#endif
+    return size;
+}
+
+/*
+ * Set the tiles cache of the current context up, if tiles are cached on
+ * demand, the pre-shifted sprites cache (GFXPC) and draw buffers
+ */
+bool
+draw_init(void)
+{
+#if defined(ENABLE_TILES_CACHE) && TILES_CACHE_SLOTS
+    U8 *block;
+
+    /* slots first: pointers alignment */
+    block = sysmem_push(TILES_CACHE_SLOTS * sizeof(context_cacheSlot_t) +
+                        TILES_CACHE_KEYS * sizeof(U16) +
+                        TILES_CACHE_SLOTS * TILES_CACHE_TILESIZE);
+    if (!block)
+    {
+        return false;
+    }
+    game_ctx->tilesCache.slots = (context_cacheSlot_t *)block;
+    game_ctx->tilesCache.index = (U16 *)(block + TILES_CACHE_SLOTS * sizeof(context_cacheSlot_t));
+    game_ctx->tilesCache.tiles = (U8 *)(game_ctx->tilesCache.index + TILES_CACHE_KEYS);
+
+    lruCache_init(game_ctx->tilesCache.slots, TILES_CACHE_SLOTS,
+                  game_ctx->tilesCache.index, TILES_CACHE_KEYS, &game_ctx->tilesCache.head);
+#endif
+#if defined(GFXPC) && defined(ENABLE_SPRITES_CACHE)
+    {
+        U32 keys = (U32)sprites_nbr_sprites * 8;
+        U32 slots = (U32)SPRITES_CACHE_BUDGET * 1024 / SPRITES_CACHE_SIZE;
+        U8 *block;
+
+        if (slots > keys)
+        {
+            slots = keys;
+        }
+        if (slots && keys < 0xffff)  /* else sprites are shifted as they are drawn */
+        {
+            block = sysmem_push(slots * sizeof(context_cacheSlot_t) +
+                                keys * sizeof(U16) +
+                                slots * SPRITES_CACHE_SIZE);
+            if (!block)
+            {
+                return false;
+            }
+            game_ctx->spritesCache.slots = (context_cacheSlot_t *)block;
+            game_ctx->spritesCache.index = (U16 *)(block + slots * sizeof(context_cacheSlot_t));
+            game_ctx->spritesCache.sprites = (U8 *)(game_ctx->spritesCache.index + keys);
+            game_ctx->spritesCache.nbrSlots = (U16)slots;
+            lruCache_init(game_ctx->spritesCache.slots, (U16)slots,
+                          game_ctx->spritesCache.index, (U16)keys, &game_ctx->spritesCache.head);
+        }
+    }
+#endif
+    {
+        size_t size = draw_buffersSize();
+        U8 *block = game_ctx->drawBuffers.block;
+
+        if (size && !block)
+        {
+            block = sysmem_push(size);
+            if (!block)
+            {
+                return false;
+            }
+            game_ctx->drawBuffers.block = block;
+            game_ctx->drawBuffers.pushed = true;
+        }
+#ifdef ENABLE_SAVE_UNDER
+        game_ctx->saveUnder.pixels = block;
+        block += ENT_ENTSNUM * DRAW_SAVEUNDER_SIZE;
+#endif
+#ifdef ENABLE_MAP_LAYER
+        game_ctx->mapLayer.pixels = block;
+        game_ctx->mapLayer.status = block + DRAW_MAPLAYER_WIDTH * DRAW_MAPLAYER_HEIGHT;
+#endif
+    }
+    return true;
+}
+
+void
+draw_shutdown(void)
+{
+#ifdef ENABLE_MAP_LAYER
+    if (game_ctx->mapLayer.rebuilds)
+    {
+        sys_printf("xrick/draw: map layer drawn %u times, scrolled %u times\n",
+                   game_ctx->mapLayer.rebuilds, game_ctx->mapLayer.scrolls);
+    }
+    game_ctx->mapLayer.pixels = NULL;
+    game_ctx->mapLayer.status = NULL;
+#endif
+#ifdef ENABLE_SAVE_UNDER
+    game_ctx->saveUnder.pixels = NULL;
+#endif
+    if (game_ctx->drawBuffers.pushed)
+    {
+        sysmem_pop(game_ctx->drawBuffers.block);
+        game_ctx->drawBuffers.block = NULL;
+        game_ctx->drawBuffers.pushed = false;
+    }
+#if defined(GFXPC) && defined(ENABLE_SPRITES_CACHE)
+    if (game_ctx->spritesCache.hits || game_ctx->spritesCache.misses)
+    {
+        sys_printf("xrick/draw: sprites cache %u hits, %u misses (%.1f%% hits),"
+                   " %u slots of %u bytes\n",
+                   game_ctx->spritesCache.hits, game_ctx->spritesCache.misses,
+                   100.0 * game_ctx->spritesCache.hits /
+                   (game_ctx->spritesCache.hits + game_ctx->spritesCache.misses),
+                   game_ctx->spritesCache.nbrSlots, SPRITES_CACHE_SIZE);
+    }
+    sysmem_pop(game_ctx->spritesCache.slots);
+    game_ctx->spritesCache.slots = NULL;
+#endif
+#if defined(ENABLE_TILES_CACHE) && TILES_CACHE_SLOTS
+    sysmem_pop(game_ctx->tilesCache.slots);
+    game_ctx->tilesCache.slots = NULL;
+#endif
 }
 
 /*
@@ -288,7 +758,7 @@ draw_sprite(U8 nbr, U16 x, U16 y)
     draw_setfb(x, y);
 
     for (i = 0; i < SPRITES_NBR_COLS; i++) {  /* for each tile column */
-        f = fb;  /* frame buffer */
+        f = game_ctx->draw.fb;  /* frame buffer */
         for (j = 0; j < SPRITES_NBR_ROWS; j++) {  /* for each pixel row */
             xm = sprites_data[nbr][i][j].mask;  /* mask */
             xp = sprites_data[nbr][i][j].pict;  /* picture */
@@ -300,7 +770,7 @@ draw_sprite(U8 nbr, U16 x, U16 y)
                 f[k] = (f[k] & (xm & 3)) | (xp & 3);
             f += SYSVID_WIDTH;
         }
-        fb += 8;
+        game_ctx->draw.fb += 8;
     }
 }
 #endif
@@ -322,27 +792,28 @@ draw_sprite(U8 number, U16 x, U16 y)
     draw_setfb(x, y);
     g = 0;
     for (i = 0; i < SPRITES_NBR_ROWS; i++) { /* rows */
-        f = fb;
+        f = game_ctx->draw.fb;
         for (j = 0; j < SPRITES_NBR_COLS; j++) { /* cols */
             d = sprites_data[number][g++];
             for (k = 8; k--; d >>= 4)
                 if (d & 0x0F) f[k] = (f[k] & 0xF0) | (d & 0x0F);
             f += 8;
         }
-        fb += SYSVID_WIDTH;
+        game_ctx->draw.fb += SYSVID_WIDTH;
     }
 }
 #endif
 
 
 /*
- * Draw a sprite
+ * Draw a sprite, testing every pixel for clipping, foreground tiles and
+ * highlighting. Reference for the implementations below, see bench.c
  *
  * NOTE re-using original ST graphics format
  */
 #ifdef GFXST
 void
-draw_sprite2(U8 number, U16 x, U16 y, bool front)
+draw_sprite2Generic(U8 number, U16 x, U16 y, bool front)
 {
   U32 d = 0;   /* sprite data */
   S16 x0, y0;  /* clipped x, y */
@@ -351,7 +822,8 @@ draw_sprite2(U8 number, U16 x, U16 y, bool front)
     r, c,      /* row, column */
     i,         /* frame buffer shifter */
     im;        /* tile flag shifter */
-  U8 flg;      /* tile flag */
+  U8 flg;      /* foreground tile */
+  U8 *f;       /* frame buffer */
 
   x0 = x;
   y0 = y;
@@ -367,34 +839,36 @@ draw_sprite2(U8 number, U16 x, U16 y, bool front)
   for (r = 0; r < SPRITES_NBR_ROWS; r++) {
     if (r >= h || y + r < y0) continue;
 
+    f = game_ctx->draw.fb;
     i = 0x1f;
     im = x - (x & 0xfff8);
-    flg = map_eflg[map_map[(y + r) >> 3][(x + 0x1f)>> 3]];
+    /* x wraps around when the sprite crosses the left edge: so do columns */
+    flg = (map_fgnd((y + r) >> 3) >> (((x + 0x1f) >> 3) & 0x1f)) & 1;
 
 #ifdef ENABLE_CHEATS
 #define LOOP(N, C0, C1) \
     d = sprites_data[number][g + N]; \
     for (c = C0; c >= C1; c--, i--, d >>= 4, im--) { \
       if (im == 0) { \
-    flg = map_eflg[map_map[(y + r) >> 3][(x + c) >> 3]]; \
+    flg = (map_fgnd((y + r) >> 3) >> (((x + c) >> 3) & 0x1f)) & 1; \
     im = 8; \
       } \
       if (c >= w || x + c < x0) continue; \
-      if (!front && !game_cheat3 && (flg & MAP_EFLG_FGND)) continue; \
-      if (d & 0x0F) fb[i] = (fb[i] & 0xF0) | (d & 0x0F); \
-      if (game_cheat3) fb[i] |= 0x10; \
+      if (!front && !game_cheat3 && flg) continue; \
+      if (d & 0x0F) f[i] = (f[i] & 0xF0) | (d & 0x0F); \
+      if (game_cheat3) f[i] |= 0x10; \
     }
 #else
 #define LOOP(N, C0, C1) \
     d = sprites_data[number][g + N]; \
     for (c = C0; c >= C1; c--, i--, d >>= 4, im--) { \
       if (im == 0) { \
-    flg = map_eflg[map_map[(y + r) >> 3][(x + c) >> 3]]; \
+    flg = (map_fgnd((y + r) >> 3) >> (((x + c) >> 3) & 0x1f)) & 1; \
     im = 8; \
       } \
-      if (!front && (flg & MAP_EFLG_FGND)) continue; \
+      if (!front && flg) continue; \
       if (c >= w || x + c < x0) continue; \
-      if (d & 0x0F) fb[i] = (fb[i] & 0xF0) | (d & 0x0F); \
+      if (d & 0x0F) f[i] = (f[i] & 0xF0) | (d & 0x0F); \
     }
 #endif
     LOOP(3, 0x1f, 0x18);
@@ -404,7 +878,7 @@ draw_sprite2(U8 number, U16 x, U16 y, bool front)
 
 #undef LOOP
 
-    fb += SYSVID_WIDTH;
+    game_ctx->draw.fb += SYSVID_WIDTH;
     g += SPRITES_NBR_COLS;
   }
 }
@@ -412,59 +886,356 @@ draw_sprite2(U8 number, U16 x, U16 y, bool front)
 #endif
 
 
+/*
+ * Sprite blitters, one per combination of clipping, hiding behind
+ * foreground tiles and highlighting: the tests that do not apply to a
+ * sprite are left out of its pixel loop.
+ *
+ * number: sprite number
+ * x, y: sprite position (pixels, map)
+ * x0, w: clipped x, width
+ * rmin, rmax: visible rows
+ * fb: first visible row, CHANGED
+ */
+#if defined(GFXST) && !defined(ENABLE_SPRITES_CACHE)
+typedef void (*sprite2Blit_t)(U8, U16, U16, S16, U16, S16, S16);
+
+#define SPRITE2_BLIT(NAME, CLIP, HIDE, MARK) \
+static void \
+NAME(U8 number, U16 x, U16 y, S16 x0, U16 w, S16 rmin, S16 rmax) \
+{ \
+  const U32 *s = sprites_data[number];  /* skipped rows do not move on in the sprite */ \
+  U32 d; \
+  S16 r, c, i, n, im; \
+  U8 flg = 0, *f; \
+ \
+  for (r = rmin; r < rmax; r++, s += SPRITES_NBR_COLS) { \
+    f = game_ctx->draw.fb; \
+    im = x & 7; \
+    if (HIDE) \
+      flg = (map_fgnd((y + r) >> 3) >> (((x + 0x1f) >> 3) & 0x1f)) & 1; \
+    for (n = SPRITES_NBR_COLS - 1, c = 0x1f; n >= 0; n--) { \
+      d = s[n]; \
+      for (i = 0; i < 8; i++, c--, d >>= 4, im--) { \
+    if (HIDE && im == 0) { \
+      flg = (map_fgnd((y + r) >> 3) >> (((x + c) >> 3) & 0x1f)) & 1; \
+      im = 8; \
+    } \
+    if (CLIP && (c >= w || x + c < x0)) continue; \
+    if (HIDE && flg) continue; \
+    if (d & 0x0F) f[c] = (f[c] & 0xF0) | (d & 0x0F); \
+    if (MARK) f[c] |= 0x10; \
+      } \
+    } \
+    game_ctx->draw.fb += SYSVID_WIDTH; \
+  } \
+}
+
+SPRITE2_BLIT(sprite2Blit000, 0, 0, 0)
+SPRITE2_BLIT(sprite2Blit001, 0, 0, 1)
+SPRITE2_BLIT(sprite2Blit010, 0, 1, 0)
+SPRITE2_BLIT(sprite2Blit011, 0, 1, 1)
+SPRITE2_BLIT(sprite2Blit100, 1, 0, 0)
+SPRITE2_BLIT(sprite2Blit101, 1, 0, 1)
+SPRITE2_BLIT(sprite2Blit110, 1, 1, 0)
+SPRITE2_BLIT(sprite2Blit111, 1, 1, 1)
+
+#undef SPRITE2_BLIT
+
+static const sprite2Blit_t sprite2Blits[2][2][2] = {  /* [clip][hide][mark] */
+  { { sprite2Blit000, sprite2Blit001 }, { sprite2Blit010, sprite2Blit011 } },
+  { { sprite2Blit100, sprite2Blit101 }, { sprite2Blit110, sprite2Blit111 } }
+};
+
 /*
  * Draw a sprite
- * align to tile column, determine plane automatically, and clip
  *
- * nbr: sprite number
- * x, y: sprite position (pixels, map).
- * fb: CHANGED
+ * Same as draw_sprite2Generic, with a blitter picked once per sprite.
  */
-#ifdef GFXPC
 void
 draw_sprite2(U8 number, U16 x, U16 y, bool front)
 {
-  U8 k, *f, c, r, dx;
-  U16 cmax, rmax;
-  U16 xm = 0, xp = 0;
-  S16 xmap, ymap;
+  S16 x0, y0;      /* clipped x, y */
+  U16 w, h;        /* width, height */
+  S16 rmin, rmax;  /* visible rows */
+  bool clip, hide, mark;
 
-  /* align to tile column, prepare map coordinate and clip */
-  xmap = x & 0xFFF8;
-  ymap = y;
-  cmax = SPRITES_NBR_COLS * 8;  /* width, 4 tile columns, 8 pixels each */
-  rmax = SPRITES_NBR_ROWS;  /* height, 15 pixels */
-  dx = (x - xmap) * 2;
-  if (draw_clipms(&xmap, &ymap, &cmax, &rmax))  /* return if not visible */
-    return;
+  x0 = x;
+  y0 = y;
+  w = SPRITES_NBR_COLS * 8; /* each tile column is 8 pixels */
+  h = SPRITES_NBR_ROWS;
 
-  /* get back to screen */
-  draw_setfb(xmap - DRAW_XYMAP_SCRLEFT, ymap - DRAW_XYMAP_SCRTOP);
-  xmap >>= 3;
-  cmax >>= 3;
+  if (draw_clipms(&x0, &y0, &w, &h))  /* return if not visible */
+    return;
 
-  /* draw */
-  for (c = 0; c < cmax; c++) {  /* for each tile column */
-    f = fb;
-    for (r = 0; r < rmax; r++) {  /* for each pixel row */
-      /* check that tile is not hidden behind foreground */
+  rmin = (y0 > y) ? y0 - y : 0;
+  rmax = (h < SPRITES_NBR_ROWS) ? h : SPRITES_NBR_ROWS;
+  clip = (w < SPRITES_NBR_COLS * 8 || x0 > x);
 #ifdef ENABLE_CHEATS
-      if (front || game_cheat3 ||
-      !(map_eflg[map_map[(ymap + r) >> 3][xmap + c]] & MAP_EFLG_FGND)) {
+  hide = !front && !game_cheat3;
+  mark = game_cheat3;
 #else
-      if (front ||
-      !(map_eflg[map_map[(ymap + r) >> 3][xmap + c]] & MAP_EFLG_FGND)) {
+  hide = !front;
+  mark = false;
 #endif
-    xp = xm = 0;
-    if (c > 0) {
-      xm |= sprites_data[number][c - 1][r].mask << (16 - dx);
-      xp |= sprites_data[number][c - 1][r].pict << (16 - dx);
+
+  draw_setfb(x0 - DRAW_XYMAP_SCRLEFT, y0 - DRAW_XYMAP_SCRTOP + 8);
+  sprite2Blits[clip][hide][mark](number, x, y, x0, w, rmin, rmax);
+}
+#endif /* GFXST && !ENABLE_SPRITES_CACHE */
+
+
+/*
+ * Draw a sprite, from the decoded sprites cache
+ *
+ * Same as above, one row at a time. Which pixels are visible only changes
+ * with the map row: it is worked out once per map row the sprite covers,
+ * and a sprite fully hidden behind foreground tiles is not drawn at all.
+ */
+#if defined(GFXST) && defined(ENABLE_SPRITES_CACHE)
+void
+draw_sprite2(U8 number, U16 x, U16 y, bool front)
+{
+    U8 mask[SPRITES_CACHE_WIDTH];  /* 0xff for visible pixels */
+    U32 visible[SPRITES_CACHE_MROWS];  /* visible pixels, per map row */
+    U32 clip, any;
+    const U8 *s;   /* decoded sprite row */
+    S16 x0, y0;    /* clipped x, y */
+    U16 w, h;      /* width, height */
+    S16 r, c;      /* row, column */
+    S16 rmin, rmax;  /* visible rows */
+    S16 cmin;      /* first visible column */
+    U8 m, mtop, mcur;  /* map rows */
+    bool hide;     /* sprite goes behind foreground tiles */
+    bool mark;     /* highlight sprite */
+
+    x0 = x;
+    y0 = y;
+    w = SPRITES_CACHE_WIDTH;
+    h = SPRITES_NBR_ROWS;
+
+    if (draw_clipms(&x0, &y0, &w, &h))  /* return if not visible */
+    {
+        return;
     }
-    else
-      xm |= 0xFFFF << (16 - dx);
-    if (c < cmax) {
-      xm |= sprites_data[number][c][r].mask >> dx;
-      xp |= sprites_data[number][c][r].pict >> dx;
+
+    /* x wraps around when the sprite crosses the left edge: see above */
+    cmin = (x0 > x) ? x0 - x : 0;
+    clip = (w > cmin) ? (0xffffffffU >> (32 - (w - cmin))) << cmin : 0;
+    rmin = (y0 > y) ? y0 - y : 0;
+    rmax = (h < SPRITES_NBR_ROWS) ? h : SPRITES_NBR_ROWS;
+    if (rmax <= rmin)
+    {
+        return;
+    }
+#ifdef ENABLE_CHEATS
+    hide = !front && !game_cheat3;
+    mark = game_cheat3;
+#else
+    hide = !front;
+    mark = false;
+#endif
+
+    mtop = (y + rmin) >> 3;
+    any = 0;
+    for (m = 0; m <= ((y + rmax - 1) >> 3) - mtop; m++)
+    {
+        visible[m] = hide ? spritesCache_visible(x, mtop + m, clip) : clip;
+        any |= visible[m];
+    }
+    if (!any)
+    {
+        return;
+    }
+
+    draw_setfb(x0 - DRAW_XYMAP_SCRLEFT, y0 - DRAW_XYMAP_SCRTOP + 8);
+
+    /* skipped rows do not move on in the sprite */
+    s = spritesCache + number * SPRITES_CACHE_SIZE;
+    mcur = 0xff;
+    for (r = rmin; r < rmax; r++)
+    {
+        m = ((y + r) >> 3) - mtop;
+        if (visible[m])
+        {
+            if (m != mcur)
+            {
+                for (c = 0; c < SPRITES_CACHE_WIDTH; c++)
+                {
+                    mask[c] = ((visible[m] >> c) & 1) ? 0xff : 0;
+                }
+                mcur = m;
+            }
+            spritesCache_blend(game_ctx->draw.fb, s, mask, mark);
+        }
+        game_ctx->draw.fb += SYSVID_WIDTH;
+        s += SPRITES_CACHE_WIDTH;
+    }
+}
+
+/*
+ * Visible pixels of a sprite row, bit c for column c: those within clip,
+ * minus those over foreground tiles
+ *
+ * x: sprite position (pixels, map)
+ * mrow: map row
+ */
+static U32
+spritesCache_visible(U16 x, U8 mrow, U32 clip)
+{
+    U32 fgnd, hidden;
+    U8 col, shift, t;
+
+    /* the sprite covers up to 5 tile columns, from col, wrapping around */
+    col = (x >> 3) & 0x1f;
+    fgnd = map_fgnd(mrow);
+    if (col)
+    {
+        fgnd = (fgnd >> col) | (fgnd << (32 - col));
+    }
+    if (!fgnd)
+    {
+        return clip;
+    }
+
+    shift = x & 7;  /* pixels of the first tile column left of the sprite */
+    hidden = 0;
+    for (t = 0; t < 5; t++)
+    {
+        if (!((fgnd >> t) & 1))
+        {
+            continue;
+        }
+        if (t == 0)
+        {
+            hidden |= 0xffU >> shift;
+        }
+        else if (8 * t - shift < 32)
+        {
+            hidden |= 0xffU << (8 * t - shift);
+        }
+    }
+    return clip & ~hidden;
+}
+
+/*
+ * Blend a decoded sprite row onto the frame buffer: where the mask is set
+ * and the sprite is not transparent, the low nibble of the frame buffer
+ * takes the sprite colour. Highlighting sets bit 4 wherever the mask is set.
+ */
+static void
+spritesCache_blend(U8 *f, const U8 *s, const U8 *mask, bool mark)
+{
+    U8 i;
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i low = _mm_set1_epi8(0x0F);
+    const __m128i bit4 = _mm_set1_epi8(0x10);
+
+    for (i = 0; i < SPRITES_CACHE_WIDTH; i += 16)
+    {
+        __m128i sv = _mm_load_si128((const __m128i *)(s + i));
+        __m128i mv = _mm_loadu_si128((const __m128i *)(mask + i));
+        __m128i fv = _mm_loadu_si128((const __m128i *)(f + i));
+        /* visible and opaque, restricted to the low nibble */
+        __m128i m = _mm_and_si128(_mm_andnot_si128(_mm_cmpeq_epi8(sv, zero), mv), low);
+
+        fv = _mm_or_si128(_mm_andnot_si128(m, fv), _mm_and_si128(sv, m));
+        if (mark)
+        {
+            fv = _mm_or_si128(fv, _mm_and_si128(mv, bit4));
+        }
+        _mm_storeu_si128((__m128i *)(f + i), fv);
+    }
+#elif defined(__ARM_NEON)
+    const uint8x16_t low = vdupq_n_u8(0x0F);
+    const uint8x16_t bit4 = vdupq_n_u8(0x10);
+
+    for (i = 0; i < SPRITES_CACHE_WIDTH; i += 16)
+    {
+        uint8x16_t sv = vld1q_u8(s + i);
+        uint8x16_t mv = vld1q_u8(mask + i);
+        uint8x16_t fv = vld1q_u8(f + i);
+        /* visible and opaque, restricted to the low nibble */
+        uint8x16_t m = vandq_u8(vandq_u8(vtstq_u8(sv, sv), mv), low);
+
+        fv = vbslq_u8(m, sv, fv);
+        if (mark)
+        {
+            fv = vorrq_u8(fv, vandq_u8(mv, bit4));
+        }
+        vst1q_u8(f + i, fv);
+    }
+#else
+    for (i = 0; i < SPRITES_CACHE_WIDTH; i++)
+    {
+        if (mask[i] && s[i])
+        {
+            f[i] = (f[i] & 0xF0) | s[i];
+        }
+        if (mark)
+        {
+            f[i] |= mask[i] & 0x10;
+        }
+    }
+#endif
+}
+#endif /* GFXST && ENABLE_SPRITES_CACHE */
+
+
+/*
+ * Draw a sprite
+ * align to tile column, determine plane automatically, and clip
+ *
+ * nbr: sprite number
+ * x, y: sprite position (pixels, map).
+ * fb: CHANGED
+ */
+#ifdef GFXPC
+void
+draw_sprite2Generic(U8 number, U16 x, U16 y, bool front)
+{
+  U8 k, *f, c, r, dx;
+  U16 cmax, rmax;
+  U16 xm = 0, xp = 0;
+  S16 xmap, ymap;
+
+  /* align to tile column, prepare map coordinate and clip */
+  xmap = x & 0xFFF8;
+  ymap = y;
+  cmax = SPRITES_NBR_COLS * 8;  /* width, 4 tile columns, 8 pixels each */
+  rmax = SPRITES_NBR_ROWS;  /* height, 15 pixels */
+  dx = (x - xmap) * 2;
+  if (draw_clipms(&xmap, &ymap, &cmax, &rmax))  /* return if not visible */
+    return;
+
+  /* get back to screen */
+  draw_setfb(xmap - DRAW_XYMAP_SCRLEFT, ymap - DRAW_XYMAP_SCRTOP);
+  xmap >>= 3;
+  cmax >>= 3;
+
+  /* draw */
+  for (c = 0; c < cmax; c++) {  /* for each tile column */
+    f = game_ctx->draw.fb;
+    for (r = 0; r < rmax; r++) {  /* for each pixel row */
+      /* check that tile is not hidden behind foreground */
+#ifdef ENABLE_CHEATS
+      if (front || game_cheat3 ||
+      !((map_fgnd((ymap + r) >> 3) >> (xmap + c)) & 1)) {
+#else
+      if (front ||
+      !((map_fgnd((ymap + r) >> 3) >> (xmap + c)) & 1)) {
+#endif
+    xp = xm = 0;
+    if (c > 0) {
+      xm |= sprites_data[number][c - 1][r].mask << (16 - dx);
+      xp |= sprites_data[number][c - 1][r].pict << (16 - dx);
+    }
+    else
+      xm |= 0xFFFF << (16 - dx);
+    if (c < cmax) {
+      xm |= sprites_data[number][c][r].mask >> dx;
+      xp |= sprites_data[number][c][r].pict >> dx;
     }
     else
       xm |= 0xFFFF >> dx;
@@ -481,10 +1252,216 @@ draw_sprite2(U8 number, U16 x, U16 y, bool front)
       }
       f += SYSVID_WIDTH;
     }
-    fb += 8;
+    game_ctx->draw.fb += 8;
   }
 }
+
+
+/*
+ * Sprite blitters, one per combination of hiding behind foreground tiles
+ * and highlighting. Clipping is by whole tile columns and rows here, it
+ * costs nothing per pixel.
+ *
+ * number: sprite number
+ * xmap, ymap: clipped position (tile column, pixel row, map)
+ * cmax, rmax: clipped width (tile columns), height
+ * dx: shift within the tile column (bits)
+ * fb: CHANGED
+ */
+typedef void (*sprite2Blit_t)(U8, S16, S16, U16, U16, U8);
+
+#define SPRITE2_BLIT(NAME, HIDE, MARK) \
+static void \
+NAME(U8 number, S16 xmap, S16 ymap, U16 cmax, U16 rmax, U8 dx) \
+{ \
+  U8 k, *f, c, r; \
+  U16 xm, xp; \
+ \
+  for (c = 0; c < cmax; c++) { \
+    f = game_ctx->draw.fb; \
+    for (r = 0; r < rmax; r++, f += SYSVID_WIDTH) { \
+      if (HIDE && ((map_fgnd((ymap + r) >> 3) >> (xmap + c)) & 1)) continue; \
+      if (c > 0) { \
+    xm = (sprites_data[number][c - 1][r].mask << (16 - dx)) | \
+      (sprites_data[number][c][r].mask >> dx); \
+    xp = (sprites_data[number][c - 1][r].pict << (16 - dx)) | \
+      (sprites_data[number][c][r].pict >> dx); \
+      } \
+      else { \
+    xm = (0xFFFF << (16 - dx)) | (sprites_data[number][c][r].mask >> dx); \
+    xp = sprites_data[number][c][r].pict >> dx; \
+      } \
+      for (k = 8; k--; xm >>= 2, xp >>= 2) { \
+    f[k] = ((f[k] & (xm & 3)) | (xp & 3)); \
+    if (MARK) f[k] |= 4; \
+      } \
+    } \
+    game_ctx->draw.fb += 8; \
+  } \
+}
+
+SPRITE2_BLIT(sprite2Blit00, 0, 0)
+SPRITE2_BLIT(sprite2Blit01, 0, 1)
+SPRITE2_BLIT(sprite2Blit10, 1, 0)
+SPRITE2_BLIT(sprite2Blit11, 1, 1)
+
+#undef SPRITE2_BLIT
+
+static const sprite2Blit_t sprite2Blits[2][2] = {  /* [hide][mark] */
+  { sprite2Blit00, sprite2Blit01 },
+  { sprite2Blit10, sprite2Blit11 }
+};
+
+/*
+ * Draw a sprite
+ *
+ * Same as draw_sprite2Generic, with a blitter picked once per sprite.
+ */
+void
+draw_sprite2(U8 number, U16 x, U16 y, bool front)
+{
+  U8 dx;
+  U16 cmax, rmax;
+  S16 xmap, ymap;
+  bool hide, mark;
+
+  /* align to tile column, prepare map coordinate and clip */
+  xmap = x & 0xFFF8;
+  ymap = y;
+  cmax = SPRITES_NBR_COLS * 8;  /* width, 4 tile columns, 8 pixels each */
+  rmax = SPRITES_NBR_ROWS;  /* height, 15 pixels */
+  dx = (x - xmap) * 2;
+  if (draw_clipms(&xmap, &ymap, &cmax, &rmax))  /* return if not visible */
+    return;
+
+#ifdef ENABLE_CHEATS
+  hide = !front && !game_cheat3;
+  mark = game_cheat3;
+#else
+  hide = !front;
+  mark = false;
+#endif
+
+  /* get back to screen */
+  draw_setfb(xmap - DRAW_XYMAP_SCRLEFT, ymap - DRAW_XYMAP_SCRTOP);
+#ifdef ENABLE_SPRITES_CACHE
+  {
+    const U8 *s = spritesCache_get(number, dx >> 1);
+    if (s) {
+      spritesCache_blit(s, xmap >> 3, ymap, cmax >> 3, rmax, hide, mark);
+      return;
+    }
+  }
 #endif
+  sprite2Blits[hide][mark](number, xmap >> 3, ymap, cmax >> 3, rmax, dx);
+}
+
+#ifdef ENABLE_SPRITES_CACHE
+/*
+ * Shift and decode a sprite, by key, into rows of 32 mask bytes and 32
+ * picture bytes: the same words as the blitters above, once and for all
+ */
+static void
+spritesCache_shift(U8 *s, U16 key)
+{
+    U16 number = key >> 3;
+    U8 dx = (key & 7) * 2;
+    U8 c, r, k;
+    U16 xm, xp;
+
+    for (r = 0; r < SPRITES_NBR_ROWS; r++, s += 2 * SPRITES_CACHE_WIDTH)
+    {
+        for (c = 0; c < SPRITES_NBR_COLS; c++)
+        {
+            if (c > 0)
+            {
+                xm = (sprites_data[number][c - 1][r].mask << (16 - dx)) |
+                    (sprites_data[number][c][r].mask >> dx);
+                xp = (sprites_data[number][c - 1][r].pict << (16 - dx)) |
+                    (sprites_data[number][c][r].pict >> dx);
+            }
+            else
+            {
+                xm = (0xFFFF << (16 - dx)) | (sprites_data[number][c][r].mask >> dx);
+                xp = sprites_data[number][c][r].pict >> dx;
+            }
+            for (k = 8; k--; xm >>= 2, xp >>= 2)
+            {
+                s[c * 8 + k] = xm & 3;
+                s[SPRITES_CACHE_WIDTH + c * 8 + k] = xp & 3;
+            }
+        }
+    }
+}
+
+/*
+ * Return a sprite shifted right by shift pixels, or NULL if the game has
+ * no cache
+ */
+static const U8 *
+spritesCache_get(U8 number, U8 shift)
+{
+    U16 slot;
+    bool fill;
+
+    if (!game_ctx->spritesCache.slots)
+    {
+        return NULL;
+    }
+    slot = lruCache_slot(game_ctx->spritesCache.slots, game_ctx->spritesCache.index,
+                         &game_ctx->spritesCache.head, number * 8 + shift, &fill);
+    if (fill)
+    {
+        spritesCache_shift(game_ctx->spritesCache.sprites + slot * SPRITES_CACHE_SIZE,
+                           number * 8 + shift);
+        game_ctx->spritesCache.misses++;
+    }
+    else
+    {
+        game_ctx->spritesCache.hits++;
+    }
+    return game_ctx->spritesCache.sprites + slot * SPRITES_CACHE_SIZE;
+}
+
+/*
+ * Draw a pre-shifted sprite, as the blitters above: where visible, each
+ * frame buffer pixel is and-ed with the mask, then or-ed with the picture
+ *
+ * s: pre-shifted sprite
+ * xmap, ymap: clipped position (tile column, pixel row, map)
+ * cmax, rmax: clipped width (tile columns), height
+ * fb: CHANGED
+ */
+static void
+spritesCache_blit(const U8 *s, S16 xmap, S16 ymap, U16 cmax, U16 rmax, bool hide, bool mark)
+{
+    U8 *f = game_ctx->draw.fb;
+    uint64_t bit2 = mark ? 0x0404040404040404ULL : 0;  /* highlight */
+    uint64_t fv, mv, pv;
+    U8 c, r;
+    U32 fgnd;
+
+    for (r = 0; r < rmax; r++, f += SYSVID_WIDTH, s += 2 * SPRITES_CACHE_WIDTH)
+    {
+        fgnd = map_fgnd((ymap + r) >> 3);
+        for (c = 0; c < cmax; c++)
+        {
+            if (hide && ((fgnd >> (xmap + c)) & 1))
+            {
+                continue;
+            }
+            /* one tile column, 8 pixels, at once */
+            memcpy(&fv, f + c * 8, 8);
+            memcpy(&mv, s + c * 8, 8);
+            memcpy(&pv, s + SPRITES_CACHE_WIDTH + c * 8, 8);
+            fv = (fv & mv) | pv | bit2;
+            memcpy(f + c * 8, &fv, 8);
+        }
+    }
+    game_ctx->draw.fb += 8 * cmax;
+}
+#endif /* ENABLE_SPRITES_CACHE */
+#endif /* GFXPC */
 
 
 /*
@@ -512,6 +1489,13 @@ draw_spriteBackground(U16 x, U16 y)
   /* get back to screen */
   xs = xmap - DRAW_XYMAP_SCRLEFT;
   ys = ymap - DRAW_XYMAP_SCRTOP;
+#ifdef ENABLE_MAP_LAYER
+  if (mapLayer_usable()) {
+    mapLayer_restore(xmap, ys, cmax, rmax);
+    return;
+  }
+#endif
+
   xmap >>= 3;
   ymap >>= 3;
   cmax >>= 3;
@@ -526,12 +1510,263 @@ draw_spriteBackground(U16 x, U16 y)
     draw_setfb(xs, 8 + ys + r * 8);
 #endif
     for (c = 0; c < cmax; c++) {  /* for each column */
-      draw_tile(map_map[ymap + r][xmap + c]);
+      draw_tile(map_tile(ymap + r, xmap + c));
     }
   }
 }
 
 
+#ifdef ENABLE_SAVE_UNDER
+/*
+ * Save what is under a sprite about to be drawn, for draw_restoreSprite
+ *
+ * Only the rectangle draw_sprite2 draws in is saved. The status bar is
+ * cleared and drawn over sprites every frame, and draw_spriteBackground
+ * covers whole tiles: sprites it would redraw the status bar under are
+ * left to it.
+ *
+ * slot: entity number
+ * x, y: sprite position (pixels, map)
+ */
+void
+draw_saveSprite(U8 slot, U16 x, U16 y)
+{
+    rect_t *rect = &game_ctx->saveUnder.rects[slot];
+    U8 *s = game_ctx->saveUnder.pixels + slot * DRAW_SAVEUNDER_SIZE;
+    const U8 *f;
+    S16 x0, y0;
+    U16 w, h, r;
+
+    /* where draw_spriteBackground would redraw the map */
+    x0 = x & 0xFFF8;
+    y0 = y & 0xFFF8;
+    w = (x - x0 == 0 ? 0x20 : 0x28);
+    h = (y & 0x04) ? 0x20 : 0x18;
+    game_ctx->saveUnder.redraw &= ~(1U << slot);
+    if (!draw_clipms(&x0, &y0, &w, &h))
+    {
+        x0 -= DRAW_XYMAP_SCRLEFT;
+        y0 -= DRAW_XYMAP_SCRTOP;
+#ifdef GFXST
+        y0 += 8;
+#endif
+        if (x0 < draw_STATUSRECT.x + draw_STATUSRECT.width && draw_STATUSRECT.x < x0 + w &&
+            y0 < draw_STATUSRECT.y + draw_STATUSRECT.height && draw_STATUSRECT.y < y0 + h)
+        {
+            game_ctx->saveUnder.redraw |= 1U << slot;
+        }
+    }
+
+    /* where draw_sprite2 draws */
+#ifdef GFXPC
+    x0 = x & 0xFFF8;
+#endif
+#ifdef GFXST
+    x0 = x;
+#endif
+    y0 = y;
+    w = SPRITES_NBR_COLS * 8;
+    h = SPRITES_NBR_ROWS;
+    if (draw_clipms(&x0, &y0, &w, &h))
+    {
+        rect->width = rect->height = 0;
+        return;
+    }
+#ifdef GFXPC
+    w &= 0xFFF8;  /* whole tile columns */
+#endif
+    rect->x = x0 - DRAW_XYMAP_SCRLEFT;
+    rect->y = y0 - DRAW_XYMAP_SCRTOP;
+#ifdef GFXST
+    rect->y += 8;
+#endif
+    rect->width = w;
+    rect->height = h;
+
+    f = sysvid_fb + rect->x + rect->y * SYSVID_WIDTH;
+    if (w == DRAW_SAVEUNDER_WIDTH)  /* not clipped, the usual case: constant size copies */
+    {
+        for (r = 0; r < h; r++, f += SYSVID_WIDTH, s += DRAW_SAVEUNDER_WIDTH)
+        {
+            memcpy(s, f, DRAW_SAVEUNDER_WIDTH);
+        }
+    }
+    else
+    {
+        for (r = 0; r < h; r++, f += SYSVID_WIDTH, s += DRAW_SAVEUNDER_WIDTH)
+        {
+            memcpy(s, f, w);
+        }
+    }
+    game_ctx->saveUnder.valid = true;
+}
+
+/*
+ * Put back what was under a sprite, as saved by draw_saveSprite
+ *
+ * Sprites must be restored in the reverse order they were drawn in, each
+ * one having been saved over those drawn before it.
+ *
+ * slot: entity number
+ * return: false if the map behind the sprite must be redrawn instead
+ */
+bool
+draw_restoreSprite(U8 slot)
+{
+    const rect_t *rect = &game_ctx->saveUnder.rects[slot];
+    const U8 *s = game_ctx->saveUnder.pixels + slot * DRAW_SAVEUNDER_SIZE;
+    U8 *f;
+    U16 r;
+
+    if (!game_ctx->saveUnder.valid || ((game_ctx->saveUnder.redraw >> slot) & 1))
+    {
+        return false;
+    }
+    f = sysvid_fb + rect->x + rect->y * SYSVID_WIDTH;
+    if (rect->width == DRAW_SAVEUNDER_WIDTH)
+    {
+        for (r = 0; r < rect->height; r++, f += SYSVID_WIDTH, s += DRAW_SAVEUNDER_WIDTH)
+        {
+            memcpy(f, s, DRAW_SAVEUNDER_WIDTH);
+        }
+    }
+    else
+    {
+        for (r = 0; r < rect->height; r++, f += SYSVID_WIDTH, s += DRAW_SAVEUNDER_WIDTH)
+        {
+            memcpy(f, s, rect->width);
+        }
+    }
+    return true;
+}
+#endif /* ENABLE_SAVE_UNDER */
+
+
+#ifdef ENABLE_MAP_LAYER
+/*
+ * Draw the status bar background, as draw_clearStatus would, into the map
+ * layer
+ */
+static void
+mapLayer_drawStatus(void)
+{
+    U8 *fb = game_ctx->draw.fb;
+    U8 tilesBank = draw_tilesBank;
+
+    game_ctx->draw.fb = game_ctx->mapLayer.status + DRAW_STATUS_SCORE_X;
+    draw_statusBackground();
+
+    game_ctx->draw.fb = fb;
+    draw_tilesBank = tilesBank;
+}
+
+/*
+ * Tell whether the map layer holds what drawing map tiles would draw now
+ */
+static bool
+mapLayer_usable(void)
+{
+    return game_ctx->mapLayer.valid &&
+#ifdef GFXPC
+           game_ctx->mapLayer.filter == draw_filter &&
+#endif
+           game_ctx->mapLayer.tilesBank == draw_tilesBank;
+}
+
+/*
+ * Get a map layer row
+ *
+ * y: row (pixels, map screen)
+ */
+static U8 *
+mapLayer_row(U16 y)
+{
+    y += game_ctx->mapLayer.top;
+    if (y >= DRAW_MAPLAYER_HEIGHT)
+    {
+        y -= DRAW_MAPLAYER_HEIGHT;
+    }
+    return game_ctx->mapLayer.pixels + y * DRAW_MAPLAYER_WIDTH;
+}
+
+/*
+ * Copy map screen rows from the frame buffer into the map layer
+ *
+ * y: first row (pixels, map screen)
+ * height: number of rows (pixels)
+ */
+static void
+mapLayer_save(U16 y, U16 height)
+{
+    const U8 *f = sysvid_fb - DRAW_XYMAP_SCRLEFT + (DRAW_MAPLAYER_TOP + y) * SYSVID_WIDTH;
+
+    for (; height; height--, y++, f += SYSVID_WIDTH)
+    {
+        memcpy(mapLayer_row(y), f, DRAW_MAPLAYER_WIDTH);
+    }
+}
+
+/*
+ * Copy a rectangle of the map layer onto the frame buffer
+ *
+ * x, y: position (pixels, map screen)
+ * width, height: size (pixels)
+ */
+static void
+mapLayer_restore(U16 x, U16 y, U16 width, U16 height)
+{
+    U8 *f = sysvid_fb - DRAW_XYMAP_SCRLEFT + x + (DRAW_MAPLAYER_TOP + y) * SYSVID_WIDTH;
+
+    /* draw_spriteBackground widths, as constant size copies */
+    if (width == 0x20)
+    {
+        for (; height; height--, y++, f += SYSVID_WIDTH)
+        {
+            memcpy(f, mapLayer_row(y) + x, 0x20);
+        }
+    }
+    else if (width == 0x28)
+    {
+        for (; height; height--, y++, f += SYSVID_WIDTH)
+        {
+            memcpy(f, mapLayer_row(y) + x, 0x28);
+        }
+    }
+    else
+    {
+        for (; height; height--, y++, f += SYSVID_WIDTH)
+        {
+            memcpy(f, mapLayer_row(y) + x, width);
+        }
+    }
+}
+#endif /* ENABLE_MAP_LAYER */
+
+
+/*
+ * Draw one row of map screen background tiles onto frame buffer.
+ *
+ * i: row, 0 (top) to 0x17 (bottom)
+ */
+static void
+draw_mapRow(U8 i)
+{
+    const U8 *tiles = map_row(i + 8);
+    U8 j;
+
+#ifdef GFXPC
+    draw_setfb(-DRAW_XYMAP_SCRLEFT, (i * 8));
+#endif
+#ifdef GFXST
+    draw_setfb(-DRAW_XYMAP_SCRLEFT, 8 + (i * 8));
+#endif
+    for (j = 0; j < 0x20; j++)  /* 0x20 tiles per row */
+    {
+        draw_tile(tiles[j]);
+    }
+}
+
+
 /*
  * Draw entire map screen background tiles onto frame buffer.
  *
@@ -540,23 +1775,103 @@ draw_spriteBackground(U16 x, U16 y)
 void
 draw_map(void)
 {
-    U8 i, j;
+    U8 i;
 
     draw_tilesBank = map_tilesBank;
+#ifdef ENABLE_SAVE_UNDER
+    game_ctx->saveUnder.valid = false;
+#endif
 
     for (i = 0; i < 0x18; i++) /* 0x18 rows */
     {
+        draw_mapRow(i);
+    }
+
+#ifdef ENABLE_MAP_LAYER
+    game_ctx->mapLayer.top = 0;
+    mapLayer_save(0, DRAW_MAPLAYER_HEIGHT);
+    mapLayer_drawStatus();
+    game_ctx->mapLayer.tilesBank = draw_tilesBank;
 #ifdef GFXPC
-        draw_setfb(-DRAW_XYMAP_SCRLEFT, (i * 8));
+    game_ctx->mapLayer.filter = draw_filter;
+#endif
+    game_ctx->mapLayer.valid = true;
+    game_ctx->mapLayer.rebuilds++;
+#endif
+}
+
+
+/*
+ * Scroll map screen by one row of tiles, once map_map has been scrolled.
+ *
+ * What is on screen already moves along with the frame buffer, and only
+ * the row coming into view is drawn. Sprites move along too: the caller
+ * translates where ent_draw() is going to erase them from.
+ *
+ * up: true when the map moves up (scroll_up), false when it moves down
+ */
+void
+draw_scrollMap(bool up)
+{
+#ifdef GFXPC
+    U8 *top = sysvid_fb - DRAW_XYMAP_SCRLEFT;
 #endif
 #ifdef GFXST
-        draw_setfb(-DRAW_XYMAP_SCRLEFT, 8 + (i * 8));
+    U8 *top = sysvid_fb - DRAW_XYMAP_SCRLEFT + 8 * SYSVID_WIDTH;
+#endif
+    U16 y;
+
+    draw_tilesBank = map_tilesBank;
+#ifdef ENABLE_SAVE_UNDER
+    game_ctx->saveUnder.valid = false;
 #endif
-        for (j = 0; j < 0x20; j++)  /* 0x20 tiles per row */
+
+    if (up)
+    {
+        for (y = 0; y < (0x18 - 1) * 8; y++)
+        {
+            memcpy(top + y * SYSVID_WIDTH, top + (y + 8) * SYSVID_WIDTH, 0x20 * 8);
+        }
+        draw_mapRow(0x17);
+    }
+    else
+    {
+        for (y = (0x18 - 1) * 8; y-- > 0; )
+        {
+            memcpy(top + (y + 8) * SYSVID_WIDTH, top + y * SYSVID_WIDTH, 0x20 * 8);
+        }
+        draw_mapRow(0);
+    }
+
+#ifdef ENABLE_MAP_LAYER
+    /* the layer scrolls along, unless the row coming in was drawn otherwise */
+    if (mapLayer_usable())
+    {
+        if (up)
+        {
+            game_ctx->mapLayer.top = (game_ctx->mapLayer.top + 8) % DRAW_MAPLAYER_HEIGHT;
+            mapLayer_save(DRAW_MAPLAYER_HEIGHT - 8, 8);
+        }
+        else
         {
-            draw_tile(map_map[i + 8][j]);
+            game_ctx->mapLayer.top = (game_ctx->mapLayer.top + DRAW_MAPLAYER_HEIGHT - 8) % DRAW_MAPLAYER_HEIGHT;
+            mapLayer_save(0, 8);
         }
+#ifdef GFXPC
+        mapLayer_drawStatus();  /* drawn from the map */
+#endif
+        game_ctx->mapLayer.scrolls++;
     }
+    else
+    {
+        game_ctx->mapLayer.valid = false;
+    }
+#endif
+
+#ifdef GFXPC
+    /* status indicators are drawn over the map, and moved along with it */
+    draw_mapRow(DRAW_STATUS_Y / 8 + (up ? -1 : 1));
+#endif
 }
 
 
@@ -570,7 +1885,9 @@ draw_drawStatus(void)
 {
   S8 i;
   U32 sv;
-  static U8 s[7] = {0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0xfe};
+  U8 *s = game_ctx->draw.status;  /* 0x30 x 6, 0xfe */
+
+  PROFILER_BEGIN(Profiler_DRAW_STATUS);
 
   draw_tilesBank = 0;
 
@@ -594,6 +1911,8 @@ draw_drawStatus(void)
   draw_setfb(DRAW_STATUS_LIVES_X, DRAW_STATUS_Y);
   for (i = 0; i < game_lives; i++)
     draw_tile(TILES_RICK);
+
+  PROFILER_END(Profiler_DRAW_STATUS);
 }
 
 
@@ -625,6 +1944,40 @@ draw_infos(void)
  */
 void
 draw_clearStatus(void)
+{
+#ifdef ENABLE_MAP_LAYER
+  bool usable;
+  U8 r;
+
+#ifdef GFXPC
+  draw_tilesBank = map_tilesBank;
+  usable = mapLayer_usable();
+#endif
+#ifdef GFXST
+  usable = game_ctx->mapLayer.valid;  /* always the same tiles */
+#endif
+  if (usable) {
+    for (r = 0; r < 8; r++)  /* the status strip has frame buffer rows */
+      memcpy(sysvid_fb + DRAW_STATUS_SCORE_X + (DRAW_STATUS_Y + r) * SYSVID_WIDTH,
+             game_ctx->mapLayer.status + DRAW_STATUS_SCORE_X + r * SYSVID_WIDTH,
+             DRAW_STATUS_LIVES_X + 6 * 8 - DRAW_STATUS_SCORE_X);
+#ifdef GFXST
+    draw_tilesBank = 0;
+#endif
+    return;
+  }
+#endif
+  draw_setfb(DRAW_STATUS_SCORE_X, DRAW_STATUS_Y);
+  draw_statusBackground();
+}
+
+/*
+ * Draw the status bar background at fb
+ *
+ * fb: CHANGED
+ */
+static void
+draw_statusBackground(void)
 {
   U8 i;
 
@@ -634,10 +1987,9 @@ draw_clearStatus(void)
 #ifdef GFXST
   draw_tilesBank = 0;
 #endif
-  draw_setfb(DRAW_STATUS_SCORE_X, DRAW_STATUS_Y);
   for (i = 0; i < DRAW_STATUS_LIVES_X/8 + 6 - DRAW_STATUS_SCORE_X/8; i++) {
 #ifdef GFXPC
-    draw_tile(map_map[MAP_ROW_SCRTOP + (DRAW_STATUS_Y / 8)][i]);
+    draw_tile(map_tile(MAP_ROW_SCRTOP + (DRAW_STATUS_Y / 8), i));
 #endif
 #ifdef GFXST
     draw_tile('@');
@@ -660,14 +2012,14 @@ draw_pic(const pic_t * picture)
     pp = 0;
 
     for (i = 0; i < picture->height; i++) { /* rows */
-        f = fb;
+        f = game_ctx->draw.fb;
         for (j = 0; j < picture->width; j += 8) {  /* cols */
             v = picture->pixels[pp++];
             for (k = 8; k--; v >>= 4)
                 f[k] = v & 0x0F;
             f += 8;
         }
-        fb += SYSVID_WIDTH;
+        game_ctx->draw.fb += SYSVID_WIDTH;
     }
 }
 #endif
@@ -689,12 +2041,12 @@ draw_img(img_t *image)
 
     for (i = 0; i < image->height; i++) /* rows */
     {
-        f = fb;
+        f = game_ctx->draw.fb;
         for (j = 0; j < image->width; j++) /* cols */
         {
             f[j] = image->pixels[pp++];
         }
-        fb += SYSVID_WIDTH;
+        game_ctx->draw.fb += SYSVID_WIDTH;
     }
 }
 
@@ -17,6 +17,7 @@
 #define _DRAW_H
 
 #include "xrick/rects.h"
+#include "xrick/context.h"
 #include "xrick/data/img.h"
 #ifdef GFXST
 #include "xrick/data/pics.h"
@@ -30,18 +31,37 @@
 /* map coordinates of the top of the hidden bottom of the map */
 #define DRAW_XYMAP_HBTOP (0x0100)
 
-extern U8 *draw_tllst;
+/* counters positions (pixels, screen) */
 #ifdef GFXPC
-extern U16 draw_filter;
+#define DRAW_STATUS_SCORE_X 0x28
+#define DRAW_STATUS_LIVES_X 0xE8
+#define DRAW_STATUS_Y 0x08
 #endif
-extern U8 draw_tilesBank;
+#define DRAW_STATUS_BULLETS_X 0x68
+#define DRAW_STATUS_BOMBS_X 0xA8
+#ifdef GFXST
+#define DRAW_STATUS_SCORE_X 0x20
+#define DRAW_STATUS_LIVES_X 0xF0
+#define DRAW_STATUS_Y 0
+#endif
+
+#define draw_tllst (game_ctx->draw.tllst)
+#ifdef GFXPC
+#define draw_filter (game_ctx->draw.filter)
+#endif
+#define draw_tilesBank (game_ctx->draw.tilesBank)
 
-extern rect_t draw_STATUSRECT;
+#define draw_STATUSRECT (game_ctx->draw.statusRect)
 extern const rect_t draw_SCREENRECT; /* whole fb */
 
 extern size_t game_color_count;
 extern img_color_t *game_colors;
 
+extern bool draw_load(void);
+extern void draw_unload(void);
+extern size_t draw_buffersSize(void);
+extern bool draw_init(void);
+extern void draw_shutdown(void);
 extern void draw_setfb(U16, U16);
 extern bool draw_clipms(S16 *, S16 *, U16 *, U16 *);
 extern void draw_tilesList(void);
@@ -50,8 +70,14 @@ extern U8 draw_tilesSubList(void);
 extern void draw_tile(register U8);
 extern void draw_sprite(U8, U16, U16);
 extern void draw_sprite2(U8, U16, U16, bool);
+extern void draw_sprite2Generic(U8, U16, U16, bool);  /* reference, for benchmarks */
 extern void draw_spriteBackground(U16, U16);
+#ifdef ENABLE_SAVE_UNDER
+extern void draw_saveSprite(U8, U16, U16);
+extern bool draw_restoreSprite(U8);
+#endif
 extern void draw_map(void);
+extern void draw_scrollMap(bool);
 extern void draw_drawStatus(void);
 extern void draw_clearStatus(void);
 #ifdef GFXST
@@ -17,15 +17,16 @@
 #define _E_BOMB_H
 
 #include "xrick/system/basic_types.h"
+#include "xrick/context.h"
 
 #define E_BOMB_NO 3
 #define E_BOMB_ENT ent_ents[E_BOMB_NO]
 #define E_BOMB_TICKER (0x2D)
 
-extern bool e_bomb_lethal;
-extern U8 e_bomb_ticker;
-extern U8 e_bomb_xc;
-extern U16 e_bomb_yc;
+#define e_bomb_lethal (game_ctx->e_bomb.lethal)
+#define e_bomb_ticker (game_ctx->e_bomb.ticker)
+#define e_bomb_xc (game_ctx->e_bomb.xc)
+#define e_bomb_yc (game_ctx->e_bomb.yc)
 
 extern bool e_bomb_hit(U8);
 extern void e_bomb_init(U16, U16);
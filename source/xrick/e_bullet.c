@@ -20,12 +20,6 @@
 #include "xrick/ents.h"
 #include "xrick/maps.h"
 
-/*
- * public vars (for performance reasons)
- */
-S8 e_bullet_offsx;
-S16 e_bullet_xc, e_bullet_yc;
-
 /*
  * Initialize bullet
  */
@@ -72,7 +66,7 @@ e_bullet_action(U8 e/*unused*/)
         /* update bullet center coordinates */
         e_bullet_xc = E_BULLET_ENT.x + 0x0c;
         e_bullet_yc = E_BULLET_ENT.y + 0x05;
-        if (map_eflg[map_map[e_bullet_yc >> 3][e_bullet_xc >> 3]] & MAP_EFLG_SOLID)
+        if (map_eflg[map_tile(e_bullet_yc >> 3, e_bullet_xc >> 3)] & MAP_EFLG_SOLID)
         {
             /* hit something: deactivate */
             E_BULLET_ENT.n = 0;
@@ -17,12 +17,14 @@
 #define _E_BULLET_H
 
 #include "xrick/system/basic_types.h"
+#include "xrick/context.h"
 
 #define E_BULLET_NO 2
 #define E_BULLET_ENT ent_ents[E_BULLET_NO]
 
-extern S8 e_bullet_offsx;
-extern S16 e_bullet_xc, e_bullet_yc;
+#define e_bullet_offsx (game_ctx->e_bullet.offsx)
+#define e_bullet_xc (game_ctx->e_bullet.xc)
+#define e_bullet_yc (game_ctx->e_bullet.yc)
 
 extern void e_bullet_init(U16, U16);
 extern void e_bullet_action(U8);
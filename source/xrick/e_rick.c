@@ -25,13 +25,6 @@
 #include "xrick/maps.h"
 #include "xrick/util.h"
 
-/*
- * public vars
- */
-S16 e_rick_stop_x = 0;
-S16 e_rick_stop_y = 0;
-unsigned e_rick_state = 0;
-
 /*
 * public functions
 */
@@ -40,23 +33,6 @@ extern inline void e_rick_state_clear(e_rick_state_t s);
 extern inline bool e_rick_state_test(e_rick_state_t s);
 
 
-/*
- * local vars
- */
-static U8 scrawl;
-
-static bool trigger = false;
-
-static S8 offsx;
-static U8 ylow;
-static S16 offsy;
-
-static U8 seq;
-
-static U8 save_crawl, save_direction;
-static U16 save_x, save_y;
-
-
 /*
  * Box test
  *
@@ -106,9 +82,9 @@ e_rick_gozombie(void)
 #endif
 
     e_rick_state_set(E_RICK_STZOMBIE);
-    offsy = -0x0300;
-    offsx = (E_RICK_ENT.x > 0x80 ? -3 : +3);
-    ylow = 0;
+    game_ctx->e_rick.offsy = -0x0300;
+    game_ctx->e_rick.offsx = (E_RICK_ENT.x > 0x80 ? -3 : +3);
+    game_ctx->e_rick.ylow = 0;
     E_RICK_ENT.front = true;
 }
 
@@ -127,13 +103,13 @@ e_rick_z_action(void)
     E_RICK_ENT.sprite = (E_RICK_ENT.x & 0x04) ? 0x1A : 0x19;
 
     /* x */
-    E_RICK_ENT.x += offsx;
+    E_RICK_ENT.x += game_ctx->e_rick.offsx;
 
     /* y */
-    i = (E_RICK_ENT.y << 8) + offsy + ylow;
+    i = (E_RICK_ENT.y << 8) + game_ctx->e_rick.offsy + game_ctx->e_rick.ylow;
     E_RICK_ENT.y = i >> 8;
-    offsy += 0x80;
-    ylow = i;
+    game_ctx->e_rick.offsy += 0x80;
+    game_ctx->e_rick.ylow = i;
 
     /* dead when out of screen */
     if (E_RICK_ENT.y < 0 || E_RICK_ENT.y > 0x0140)
@@ -174,7 +150,7 @@ e_rick_action2(void)
     */
     e_rick_state_clear(E_RICK_STJUMP);
     /* calc y */
-    i = (E_RICK_ENT.y << 8) + offsy + ylow;
+    i = (E_RICK_ENT.y << 8) + game_ctx->e_rick.offsy + game_ctx->e_rick.ylow;
     y = i >> 8;
     /* test environment */
     u_envtest(E_RICK_ENT.x, y, e_rick_state_test(E_RICK_STCRAWL), &env0, &env1);
@@ -184,7 +160,7 @@ e_rick_action2(void)
         e_rick_state_clear(E_RICK_STCRAWL);
     }
     /* can move vertically? */
-    if (env1 & (offsy < 0 ?
+    if (env1 & (game_ctx->e_rick.offsy < 0 ?
                     MAP_EFLG_VERT|MAP_EFLG_SOLID|MAP_EFLG_SPAD :
                     MAP_EFLG_VERT|MAP_EFLG_SOLID|MAP_EFLG_SPAD|MAP_EFLG_WAYUP))
         goto vert_not;
@@ -200,19 +176,19 @@ e_rick_action2(void)
     }
     /* save */
     E_RICK_ENT.y = y;
-    ylow = i;
+    game_ctx->e_rick.ylow = i;
     /* climb? */
     if ((env1 & MAP_EFLG_CLIMB) && (control_test(Control_UP | Control_DOWN)))
     {
-        offsy = 0x0100;
+        game_ctx->e_rick.offsy = 0x0100;
         e_rick_state_set(E_RICK_STCLIMB);
         return;
     }
     /* fall */
-    offsy += 0x0080;
-    if (offsy > 0x0800) {
-        offsy = 0x0800;
-        ylow = 0;
+    game_ctx->e_rick.offsy += 0x0080;
+    if (game_ctx->e_rick.offsy > 0x0800) {
+        game_ctx->e_rick.offsy = 0x0800;
+        game_ctx->e_rick.ylow = 0;
     }
 
     /*
@@ -221,7 +197,7 @@ e_rick_action2(void)
     horiz:
     /* should move? */
     if (!(control_test(Control_LEFT | Control_RIGHT))) {
-        seq = 2; /* no: reset seq and return */
+        game_ctx->e_rick.seq = 2; /* no: reset seq and return */
         return;
     }
     if (control_test(Control_LEFT)) {  /* move left */
@@ -258,33 +234,33 @@ e_rick_action2(void)
    * NO VERTICAL MOVE
    */
  vert_not:
-  if (offsy < 0) {
+  if (game_ctx->e_rick.offsy < 0) {
     /* not climbing + trying to go _up_ not possible -> hit the roof */
     e_rick_state_set(E_RICK_STJUMP);  /* fall back to the ground */
     E_RICK_ENT.y &= 0xF8;
-    offsy = 0;
-    ylow = 0;
+    game_ctx->e_rick.offsy = 0;
+    game_ctx->e_rick.ylow = 0;
     goto horiz;
   }
   /* else: not climbing + trying to go _down_ not possible -> standing */
   /* align to ground */
   E_RICK_ENT.y &= 0xF8;
   E_RICK_ENT.y |= 0x03;
-  ylow = 0;
+  game_ctx->e_rick.ylow = 0;
 
   /* standing on a super pad? */
-  if ((env1 & MAP_EFLG_SPAD) && offsy >= 0X0200) {
-    offsy = (control_test(Control_UP)) ? 0xf800 : 0x00fe - offsy;
+  if ((env1 & MAP_EFLG_SPAD) && game_ctx->e_rick.offsy >= 0X0200) {
+    game_ctx->e_rick.offsy = (control_test(Control_UP)) ? 0xf800 : 0x00fe - game_ctx->e_rick.offsy;
 #ifdef ENABLE_SOUND
     syssnd_play(soundPad, 1);
 #endif
     goto horiz;
   }
 
-  offsy = 0x0100;  /* reset*/
+  game_ctx->e_rick.offsy = 0x0100;  /* reset*/
 
   /* standing. firing ? */
-  if (scrawl || !(control_test(Control_FIRE)))
+  if (game_ctx->e_rick.scrawl || !(control_test(Control_FIRE)))
     goto firing_not;
 
   /*
@@ -307,10 +283,10 @@ e_rick_action2(void)
   if (control_test(Control_UP)) {  /* bullet */
     e_rick_state_set(E_RICK_STSHOOT);
     /* not an automatic gun: shoot once only */
-    if (trigger)
+    if (game_ctx->e_rick.trigger)
       return;
     else
-      trigger = true;
+      game_ctx->e_rick.trigger = true;
     /* already a bullet in the air ... that's enough */
     if (E_BULLET_ENT.n)
       return;
@@ -329,8 +305,8 @@ e_rick_action2(void)
     return;
   }
 
-  trigger = false; /* not shooting means trigger is released */
-  seq = 0; /* reset */
+  game_ctx->e_rick.trigger = false; /* not shooting means trigger is released */
+  game_ctx->e_rick.seq = 0; /* reset */
 
   if (control_test(Control_DOWN)) {  /* bomb */
     /* already a bomb ticking ... that's enough */
@@ -362,8 +338,8 @@ e_rick_action2(void)
       e_rick_state_set(E_RICK_STCLIMB);
       return;
     }
-    offsy = -0x0580;  /* jump */
-    ylow = 0;
+    game_ctx->e_rick.offsy = -0x0580;  /* jump */
+    game_ctx->e_rick.ylow = 0;
 #ifdef ENABLE_SOUND
     syssnd_play(soundJump, 1);
 #endif
@@ -391,7 +367,7 @@ e_rick_action2(void)
     climbing:
         /* should move? */
         if (!(control_test(Control_UP | Control_DOWN | Control_LEFT | Control_RIGHT))) {
-            seq = 0; /* no: reset seq and return */
+            game_ctx->e_rick.seq = 0; /* no: reset seq and return */
             return;
         }
 
@@ -415,7 +391,7 @@ e_rick_action2(void)
                 }
                 if (!(env1 & (MAP_EFLG_VERT|MAP_EFLG_CLIMB))) {
                     /* reached end of climb zone */
-                    offsy = (control_test(Control_UP)) ? -0x0300 : 0x0100;
+                    game_ctx->e_rick.offsy = (control_test(Control_UP)) ? -0x0300 : 0x0100;
 #ifdef ENABLE_SOUND
                     if (control_test(Control_UP))
                         syssnd_play(soundJump, 1);
@@ -456,7 +432,7 @@ e_rick_action2(void)
     if (env1 & (MAP_EFLG_VERT|MAP_EFLG_CLIMB)) return;
     e_rick_state_clear(E_RICK_STCLIMB);
     if (control_test(Control_UP))
-      offsy = -0x0300;
+      game_ctx->e_rick.offsy = -0x0300;
   }
 }
 
@@ -468,13 +444,11 @@ e_rick_action2(void)
  */
 void e_rick_action(U8 e/*unused*/)
 {
-    static U8 stopped = false; /* is this the most elegant way? */
-
     (void)e;
 
     e_rick_action2();
 
-    scrawl = e_rick_state_test(E_RICK_STCRAWL);
+    game_ctx->e_rick.scrawl = e_rick_state_test(E_RICK_STCRAWL);
 
     if (e_rick_state_test(E_RICK_STZOMBIE))
     {
@@ -488,16 +462,16 @@ void e_rick_action(U8 e/*unused*/)
     {
         E_RICK_ENT.sprite = (game_dir ? 0x17 : 0x0B);
 #ifdef ENABLE_SOUND
-        if (!stopped)
+        if (!game_ctx->e_rick.stopped)
         {
             syssnd_play(soundStick, 1);
-            stopped = true;
+            game_ctx->e_rick.stopped = true;
         }
 #endif
         return;
     }
 
-    stopped = false;
+    game_ctx->e_rick.stopped = false;
 
     if (e_rick_state_test(E_RICK_STSHOOT))
     {
@@ -509,8 +483,8 @@ void e_rick_action(U8 e/*unused*/)
     {
         E_RICK_ENT.sprite = (((E_RICK_ENT.x ^ E_RICK_ENT.y) & 0x04) ? 0x18 : 0x0c);
 #ifdef ENABLE_SOUND
-        seq = (seq + 1) & 0x03;
-        if (seq == 0) syssnd_play(soundWalk, 1);
+        game_ctx->e_rick.seq = (game_ctx->e_rick.seq + 1) & 0x03;
+        if (game_ctx->e_rick.seq == 0) syssnd_play(soundWalk, 1);
 #endif
         return;
     }
@@ -520,8 +494,8 @@ void e_rick_action(U8 e/*unused*/)
         E_RICK_ENT.sprite = (game_dir ? 0x13 : 0x07);
         if (E_RICK_ENT.x & 0x04) E_RICK_ENT.sprite++;
 #ifdef ENABLE_SOUND
-        seq = (seq + 1) & 0x03;
-        if (seq == 0) syssnd_play(soundCrawl, 1);
+        game_ctx->e_rick.seq = (game_ctx->e_rick.seq + 1) & 0x03;
+        if (game_ctx->e_rick.seq == 0) syssnd_play(soundCrawl, 1);
 #endif
         return;
     }
@@ -532,26 +506,26 @@ void e_rick_action(U8 e/*unused*/)
         return;
     }
 
-    seq++;
+    game_ctx->e_rick.seq++;
 
-    if (seq >= 0x14)
+    if (game_ctx->e_rick.seq >= 0x14)
     {
 #ifdef ENABLE_SOUND
         syssnd_play(soundWalk, 1);
 #endif
-        seq = 0x04;
+        game_ctx->e_rick.seq = 0x04;
     }
 #ifdef ENABLE_SOUND
     else
     {
-        if (seq == 0x0C)
+        if (game_ctx->e_rick.seq == 0x0C)
         {
             syssnd_play(soundWalk, 1);
         }
     }
 #endif
 
-    E_RICK_ENT.sprite = (seq >> 2) + 1 + (game_dir ? 0x0c : 0x00);
+    E_RICK_ENT.sprite = (game_ctx->e_rick.seq >> 2) + 1 + (game_dir ? 0x0c : 0x00);
 }
 
 
@@ -562,10 +536,10 @@ void e_rick_action(U8 e/*unused*/)
  */
 void e_rick_save(void)
 {
-    save_x = E_RICK_ENT.x;
-    save_y = E_RICK_ENT.y;
-    save_crawl = e_rick_state_test(E_RICK_STCRAWL);
-    save_direction = game_dir;
+    game_ctx->e_rick.saveX = E_RICK_ENT.x;
+    game_ctx->e_rick.saveY = E_RICK_ENT.y;
+    game_ctx->e_rick.saveCrawl = e_rick_state_test(E_RICK_STCRAWL);
+    game_ctx->e_rick.saveDirection = game_dir;
     /* FIXME
      * save_C0 = E_RICK_ENT.b0C;
      * plus some 6DBC stuff?
@@ -580,9 +554,9 @@ void e_rick_save(void)
  */
 void e_rick_restore(void)
 {
-    E_RICK_ENT.x = save_x;
-    E_RICK_ENT.y = save_y;
-    if (save_crawl)
+    E_RICK_ENT.x = game_ctx->e_rick.saveX;
+    E_RICK_ENT.y = game_ctx->e_rick.saveY;
+    if (game_ctx->e_rick.saveCrawl)
     {
         e_rick_state_set(E_RICK_STCRAWL);
     }
@@ -590,7 +564,7 @@ void e_rick_restore(void)
     {
          e_rick_state_clear(E_RICK_STCRAWL);
     }
-    game_dir = save_direction;
+    game_dir = game_ctx->e_rick.saveDirection;
 
     E_RICK_ENT.front = false;
     e_rick_state_clear(E_RICK_STCLIMB); /* should we clear other states? */
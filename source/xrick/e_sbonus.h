@@ -17,10 +17,11 @@
 #define _E_SBONUS_H
 
 #include "xrick/system/basic_types.h"
+#include "xrick/context.h"
 
-extern bool e_sbonus_counting;
-extern U8 e_sbonus_counter;
-extern U16 e_sbonus_bonus;
+#define e_sbonus_counting (game_ctx->e_sbonus.counting)
+#define e_sbonus_counter (game_ctx->e_sbonus.counter)
+#define e_sbonus_bonus (game_ctx->e_sbonus.bonus)
 
 extern void e_sbonus_start(U8);
 extern void e_sbonus_stop(U8);
@@ -26,15 +26,10 @@
 #define TYPE_1A (0x00)
 #define TYPE_1B (0xff)
 
-/*
- * public vars
- */
-U32 e_them_rndseed = 0;
-
 /*
  * local vars
  */
-static U16 e_them_rndnbr = 0;
+#define e_them_rndnbr (game_ctx->e_them.rndnbr)
 
 /*
  * Check if entity boxtests with a lethal e_them i.e. something lethal
@@ -335,14 +330,14 @@ e_them_t2_action2(U8 e)
    * vars required by the Black Magic (tm) performance at the
    * end of this function.
    */
-  static U16 bx;
-  static U8 *bl = (U8 *)&bx;
-  static U8 *bh = (U8 *)&bx + 1;
-  static U16 cx;
-  static U8 *cl = (U8 *)&cx;
-  static U8 *ch = (U8 *)&cx + 1;
-  static U16 *sl = (U16 *)&e_them_rndseed;
-  static U16 *sh = (U16 *)&e_them_rndseed + 2;
+  U16 *bx = &game_ctx->e_them.bx;
+  U8 *bl = (U8 *)bx;
+  U8 *bh = (U8 *)bx + 1;
+  U16 *cx = &game_ctx->e_them.cx;
+  U8 *cl = (U8 *)cx;
+  U8 *ch = (U8 *)cx + 1;
+  U16 *sl = (U16 *)&e_them_rndseed;
+  U16 *sh = (U16 *)&e_them_rndseed + 2;
 
   /*sys_printf("e_them_t2 ------------------------------\n");*/
 
@@ -481,12 +476,12 @@ e_them_t2_action2(U8 e)
      * for the entity. it is an exact copy of what the assembler code
      * does but I can't explain.
      */
-    bx = e_them_rndnbr + *sh + *sl + 0x0d;
-    cx = *sh;
+    *bx = e_them_rndnbr + *sh + *sl + 0x0d;
+    *cx = *sh;
     *bl ^= *ch;
     *bl ^= *cl;
     *bl ^= *bh;
-    e_them_rndnbr = bx;
+    e_them_rndnbr = *bx;
 
     ent_ents[e].offsx = (*bl & 0x01) ? -0x02 : 0x02;
 
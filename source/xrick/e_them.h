@@ -17,8 +17,9 @@
 #define _E_THEM_H
 
 #include "xrick/system/basic_types.h"
+#include "xrick/context.h"
 
-extern U32 e_them_rndseed;
+#define e_them_rndseed (game_ctx->e_them.rndseed)
 
 extern void e_them_t1a_action(U8);
 extern void e_them_t1b_action(U8);
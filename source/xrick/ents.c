@@ -19,6 +19,7 @@
 #include "xrick/control.h"
 #include "xrick/game.h"
 #include "xrick/debug.h"
+#include "xrick/profiler.h"
 #include "xrick/e_bullet.h"
 #include "xrick/e_bomb.h"
 #include "xrick/e_rick.h"
@@ -35,13 +36,9 @@
 /*
  * global vars
  */
-ent_t ent_ents[ENT_ENTSNUM + 1];
-
 size_t ent_nbr_entdata = 0;
 entdata_t *ent_entdata = NULL;
 
-rect_t *ent_rects = NULL;
-
 size_t ent_nbr_sprseq = 0;
 U8 *ent_sprseq = NULL;
 
@@ -293,16 +290,15 @@ ent_actvis(U8 frow, U8 lrow)
 
 
 /*
- * Add a tile-aligned rectangle containing the given rectangle (indicated
- * by its MAP coordinates) to the list of rectangles. Clip the rectangle
- * so it fits into the display zone.
+ * Mark a tile-aligned rectangle containing the given rectangle (indicated
+ * by its MAP coordinates) as dirty. Clip the rectangle so it fits into the
+ * display zone.
  */
 static void
 ent_addrect(S16 x, S16 y, U16 width, U16 height)
 {
     S16 x0, y0;
     U16 w0, h0;
-    rect_t *r;
 
     /*sys_printf("rect %#04x,%#04x %#04x %#04x ", x, y, width, height);*/
 
@@ -330,14 +326,7 @@ ent_addrect(S16 x, S16 y, U16 width, U16 height)
     x0 -= DRAW_XYMAP_SCRLEFT;
     y0 -= DRAW_XYMAP_SCRTOP;
 
-    /* add rectangle to the list */
-    r = rects_new(x0, y0, w0, h0, ent_rects);
-    if (!r)
-    {
-        control_set(Control_EXIT);
-        return;
-    }
-    ent_rects = r;
+    rects_mark(x0, y0, w0, h0);
 }
 
 
@@ -353,25 +342,44 @@ void
 ent_draw(void)
 {
   U8 i;
-#ifdef ENABLE_CHEATS
-  static bool ch3 = false;
-#endif
   S16 dx, dy;
+#ifdef ENABLE_SAVE_UNDER
+  U16 restored = 0;  /* entities erased already, one bit each */
+#endif
 
-  draw_tilesBank = map_tilesBank;
+  PROFILER_BEGIN(Profiler_ENT_DRAW);
 
-  /* reset rectangles list */
-  rects_free(ent_rects);
-  ent_rects = NULL;
+  draw_tilesBank = map_tilesBank;
 
   /*sys_printf("\n");*/
 
+#ifdef ENABLE_SAVE_UNDER
+  /*
+   * restore loop : put back what was under entities that were visible,
+   * last drawn first
+   */
+  for (i = 0; ent_ents[i].n != 0xff; i++);
+  while (i--) {
+#ifdef ENABLE_CHEATS
+    if (ent_ents[i].prev_n && (game_ctx->ents.ch3 || ent_ents[i].prev_s))
+#else
+    if (ent_ents[i].prev_n && ent_ents[i].prev_s)
+#endif
+      if (draw_restoreSprite(i))
+        restored |= 1U << i;
+  }
+#endif
+
   /*
    * background loop : erase all entities that were visible
    */
   for (i = 0; ent_ents[i].n != 0xff; i++) {
+#ifdef ENABLE_SAVE_UNDER
+    if ((restored >> i) & 1)
+      continue;
+#endif
 #ifdef ENABLE_CHEATS
-    if (ent_ents[i].prev_n && (ch3 || ent_ents[i].prev_s))
+    if (ent_ents[i].prev_n && (game_ctx->ents.ch3 || ent_ents[i].prev_s))
 #else
     if (ent_ents[i].prev_n && ent_ents[i].prev_s)
 #endif
@@ -388,14 +396,18 @@ ent_draw(void)
      * not active before, add a rectangle for the sprite.
      */
 #ifdef ENABLE_CHEATS
-    if (ent_ents[i].n && (game_cheat3 || ent_ents[i].sprite))
+    if (ent_ents[i].n && (game_cheat3 || ent_ents[i].sprite)) {
 #else
-    if (ent_ents[i].n && ent_ents[i].sprite)
+    if (ent_ents[i].n && ent_ents[i].sprite) {
 #endif
       /* If entitiy is active, draw the sprite. */
+#ifdef ENABLE_SAVE_UNDER
+      draw_saveSprite(i, ent_ents[i].x, ent_ents[i].y);
+#endif
       draw_sprite2(ent_ents[i].sprite,
            ent_ents[i].x, ent_ents[i].y,
            ent_ents[i].front);
+    }
   }
 
   /*
@@ -404,7 +416,7 @@ ent_draw(void)
    */
   for (i = 0; ent_ents[i].n != 0xff; i++) {
 #ifdef ENABLE_CHEATS
-    if (ent_ents[i].prev_n && (ch3 || ent_ents[i].prev_s)) {
+    if (ent_ents[i].prev_n && (game_ctx->ents.ch3 || ent_ents[i].prev_s)) {
 #else
     if (ent_ents[i].prev_n && ent_ents[i].prev_s) {
 #endif
@@ -455,8 +467,10 @@ ent_draw(void)
   }
 
 #ifdef ENABLE_CHEATS
-  ch3 = game_cheat3;
+  game_ctx->ents.ch3 = game_cheat3;
 #endif
+
+  PROFILER_END(Profiler_ENT_DRAW);
 }
 
 
@@ -523,6 +537,8 @@ ent_action(void)
       }
     );
 
+  PROFILER_BEGIN(Profiler_ENT_ACTION);
+
   for (i = 0; ent_ents[i].n != 0xff; i++) {
     if (ent_ents[i].n) {
       k = ent_ents[i].n & 0x7f;
@@ -534,6 +550,8 @@ ent_action(void)
     ent_actf[k](i);
     }
   }
+
+  PROFILER_END(Profiler_ENT_ACTION);
 }
 
 
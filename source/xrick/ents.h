@@ -94,13 +94,14 @@ typedef struct {
 } mvstep_t;
 
 enum { ENT_ENTSNUM = 12 };
-extern ent_t ent_ents[ENT_ENTSNUM + 1];
+
+#include "xrick/context.h"
+
+#define ent_ents (game_ctx->ents.ents)
 
 extern size_t ent_nbr_entdata;
 extern entdata_t *ent_entdata;
 
-extern rect_t *ent_rects;
-
 extern size_t ent_nbr_sprseq;
 extern U8 *ent_sprseq;
 
@@ -25,12 +25,18 @@
 #include "xrick/rects.h"
 #include "xrick/scroller.h"
 #include "xrick/control.h"
+#include "xrick/context.h"
 #include "xrick/resources.h"
+#include "xrick/replay.h"
+#include "xrick/rewind.h"
+#include "xrick/profiler.h"
 
 #ifdef ENABLE_DEVTOOLS
 #include "xrick/devtools.h"
 #endif
 
+#include <string.h> /* memcpy, memcmp, memset */
+
 
 /*
  * local typedefs
@@ -49,37 +55,44 @@ typedef enum {
   RESTART, GAMEOVER, GETNAME, EXIT
 } game_state_t;
 
+typedef struct {
+  U32 frames;
+  U32 intervals;       /* frames with a known expected interval */
+  U32 resyncs;         /* times the schedule was given up, being too late */
+  U32 maxLateness;     /* frame start after deadline, in microsecond */
+  U32 maxDeviation;    /* frame interval vs period, in microsecond */
+  double sumLateness;
+  double sumDeviation;
+} pacing_t;
 
-/*
- * global vars
- */
-U8 game_period = 0;
-bool game_waitevt = false;
-const rect_t *game_rects = NULL;
-
-U8 game_lives = 0;
-U8 game_bombs = 0;
-U8 game_bullets = 0;
-U32 game_score = 0;
-
-U16 game_map = 0;
-U16 game_submap = 0;
-
-U8 game_dir = RIGHT;
-bool game_chsm = false;
-
-bool game_cheat1 = false;
-bool game_cheat2 = false;
-bool game_cheat3 = false;
+#define GAME_MAX_LATE_FRAMES 4  /* frames behind schedule before resynchronizing */
+#define GAME_MAX_SKIPPED_FRAMES 4  /* frames not displayed in a row when behind schedule */
 
 
 /*
  * local vars
  */
-static U8 isave_frow;
-static game_state_t game_state;
+#define isave_frow (game_ctx->game.isaveFrow)
+#define game_state (game_ctx->game.state)
 #ifdef ENABLE_SOUND
-static sound_t *currentMusic = NULL;
+#define currentMusic (game_ctx->game.music)
+#endif
+static pacing_t pacing;
+#ifdef ENABLE_PROFILER
+#define frameState (game_ctx->game.frameState)  /* state that produced the frame */
+static const char * const stateNames[] = {
+#ifdef ENABLE_DEVTOOLS
+  "DEVTOOLS",
+#endif
+  "XRICK",
+  "INIT_GAME", "INIT_BUFFER",
+  "INTRO_MAIN", "INTRO_MAP",
+  "PAUSE_PRESSED1", "PAUSE_PRESSED1B", "PAUSED", "PAUSE_PRESSED2",
+  "PLAY0", "PLAY1", "PLAY2", "PLAY3",
+  "CHAIN_SUBMAP", "CHAIN_MAP", "CHAIN_END",
+  "SCROLL_UP", "SCROLL_DOWN",
+  "RESTART", "GAMEOVER", "GETNAME", "EXIT"
+};
 #endif
 
 
@@ -93,6 +106,12 @@ static void play3(void);
 static void restart(void);
 static void isave(void);
 static void irestore(void);
+static void pacing_report(void);
+static bool waitEvents(void);
+static U8 turboTicks(void);
+#ifdef ENABLE_REPLAY
+static bool seekReplay(U32);
+#endif /* ENABLE_REPLAY */
 
 
 /*
@@ -174,93 +193,709 @@ game_stopmusic(void)
 void
 game_run(void)
 {
-    U32 currentTime,
+    U32 now, nextDeadline, frameDeadline, frameStart = 0, interval = 0;
 #ifdef ENABLE_SOUND
-        lastSoundTime = 0,
+    U32 soundDeadline;
 #endif
-        lastFrameTime = 0;
 
-    if (!resources_load())
+    if (!game_load())
     {
-        resources_unload();
         return;
     }
 
-    if (!sys_cacheData())
+    if (!game_init())
     {
-        sys_uncacheData();
+        game_shutdown();
+        game_unload();
         return;
     }
 
-    game_period = sysarg_args_period ? sysarg_args_period : GAME_PERIOD;
-    game_state = XRICK;
+    /*
+     * main loop
+     *
+     * Frames are scheduled against absolute deadlines, one game_period
+     * apart: a late frame makes the next one come sooner, so that no drift
+     * accumulates. In between, sleep until the next deadline.
+     */
+    now = sys_gettimeUs();
+    frameDeadline = now;
+#ifdef ENABLE_SOUND
+    soundDeadline = now;
+#endif
+    pacing.frames = 0;
+    pacing.intervals = 0;
+    pacing.resyncs = 0;
+    pacing.maxLateness = 0;
+    pacing.maxDeviation = 0;
+    pacing.sumLateness = 0;
+    pacing.sumDeviation = 0;
 
-    /* main loop */
     while (game_state != EXIT)
     {
-        currentTime = sys_gettime();
+        now = sys_gettimeUs();
 
-        if (currentTime - lastFrameTime >= game_period)
+        if ((S32)(now - frameDeadline) >= 0)
         {
-            /* frame */
-            frame();
-
-            /* video */
-            /*DEBUG*//*game_rects=&draw_SCREENRECT;*//*DEBUG*/
-            sysvid_update(game_rects);
+            /* pacing */
+            U32 lateness = now - frameDeadline;
+            pacing.frames++;
+            pacing.sumLateness += lateness;
+            if (lateness > pacing.maxLateness)
+                pacing.maxLateness = lateness;
+            if (interval) {
+                S32 deviation = (S32)(now - frameStart - interval);
+                if (deviation < 0)
+                    deviation = -deviation;
+                pacing.intervals++;
+                pacing.sumDeviation += deviation;
+                if ((U32)deviation > pacing.maxDeviation)
+                    pacing.maxDeviation = deviation;
+            }
+            frameStart = now;
 
-            /* reset rectangles list */
-            rects_free(ent_rects);
-            ent_rects = NULL;
-            draw_STATUSRECT.next = NULL;  /* FIXME freerects should handle this */
+            game_step();
 
-            /* events */
-            if (game_waitevt)
+            /* schedule next frame */
+            interval = game_period * 1000;
+            frameDeadline += interval;
+            now = sys_gettimeUs();
+            if ((S32)(now - frameDeadline) > (S32)(GAME_MAX_LATE_FRAMES * interval))
             {
-                sysevt_wait();  /* wait for an event */
+                /* too late to catch up (or waited for events): start over from now */
+                frameDeadline = now;
+                interval = 0;
+                game_ctx->frameskip.late = false;
+                if (!waitEvents())
+                    pacing.resyncs++;
             }
             else
             {
-                sysevt_poll();  /* process events (non-blocking) */
+                /* late: keep the game going, do not display next frame */
+                game_ctx->frameskip.late = ((S32)(now - frameDeadline) > 0);
             }
-
-            lastFrameTime = currentTime;
         }
 
 #ifdef ENABLE_SOUND
-        if (currentTime - lastSoundTime >= syssnd_period)
+        if ((S32)(now - soundDeadline) >= 0)
         {
             /* sound */
             syssnd_update();
 
-            lastSoundTime = currentTime;
+            /* sound does not need to catch up */
+            soundDeadline += syssnd_period * 1000;
+            if ((S32)(now - soundDeadline) >= 0)
+                soundDeadline = now + syssnd_period * 1000;
         }
+        nextDeadline = ((S32)(soundDeadline - frameDeadline) < 0) ? soundDeadline : frameDeadline;
+#else
+        nextDeadline = frameDeadline;
 #endif /* ENABLE_SOUND */
 
-        sys_yield();
+        sys_sleepUntil(nextDeadline);
     }
 
+    pacing_report();
+
+    game_shutdown();
+    game_unload();
+}
+
+/*
+ * Load resources shared by all games
+ */
+bool
+game_load(void)
+{
+    if (!resources_load())
+    {
+        resources_unload();
+        return false;
+    }
+
+    if (!draw_load())
+    {
+        draw_unload();
+        resources_unload();
+        return false;
+    }
+
+    if (!sys_cacheData())
+    {
+        sys_uncacheData();
+        draw_unload();
+        resources_unload();
+        return false;
+    }
+
+#ifdef ENABLE_PROFILER
+    if (!profiler_init(stateNames, sizeof(stateNames) / sizeof(*stateNames)))
+    {
+        sys_uncacheData();
+        draw_unload();
+        resources_unload();
+        return false;
+    }
+#endif /* ENABLE_PROFILER */
+
+    return true;
+}
+
+/*
+ * Release resources shared by all games
+ */
+void
+game_unload(void)
+{
+#ifdef ENABLE_PROFILER
+    profiler_shutdown();
+#endif /* ENABLE_PROFILER */
+
+    sys_uncacheData();
+
+    draw_unload();
+
+    resources_unload();
+}
+
+/*
+ * Prepare the game of the current context
+ *
+ * Frame buffer, entity marks and high scores must be set up. Whatever
+ * the outcome, game_shutdown must be called afterwards.
+ */
+bool
+game_init(void)
+{
+    context_init(game_ctx);
+
+#ifdef ENABLE_REPLAY
+    if (!replay_open())
+    {
+        return false;
+    }
+#endif /* ENABLE_REPLAY */
+
+#ifdef ENABLE_REWIND
+    if (!rewind_open())
+    {
+        return false;
+    }
+#endif /* ENABLE_REWIND */
+
+    if (!draw_init())
+    {
+        return false;
+    }
+
+    game_period = sysarg_args_period ? sysarg_args_period : GAME_PERIOD;
+    game_state = XRICK;
+
+    if (sysarg_args_load && !game_loadSnapshot(sysarg_args_load))
+    {
+        return false;
+    }
+
+#ifdef ENABLE_REPLAY
+    if (sysarg_args_replayFrom && !seekReplay(sysarg_args_replayFrom))
+    {
+        return false;
+    }
+#endif /* ENABLE_REPLAY */
+    return true;
+}
+
+/*
+ * Tell whether the game of the current context is between two frames of
+ * play, its entities being as they were last drawn
+ */
+bool
+game_inPlay(void)
+{
+    return game_state == PLAY0;
+}
+
+/*
+ * Run one frame of the game of the current context
+ *
+ * Return false once the game has exited.
+ */
+bool
+game_step(void)
+{
+    U8 ticks = turboTicks();
+    U8 i;
+
+    if (ticks > 1)
+    {
+        game_ctx->frameskip.turbo = true;
+    }
+    else if (game_ctx->frameskip.turbo)
+    {
+        /* turbo ended: redraw everything */
+        game_ctx->frameskip.turbo = false;
+        if (game_state == PLAY0)
+        {
+            ent_clprev();
+            draw_map();
+            draw_clearStatus();
+            ent_draw();
+            draw_drawStatus();
+            rects_markList(&draw_SCREENRECT);
+        }
+    }
+
+    for (i = 0; i < ticks && game_state != EXIT; ++i)
+    {
+        /* only the last tick is displayed, unless running late */
+        game_ctx->frameskip.skip = (i + 1 < ticks);
+        if (!game_ctx->frameskip.skip && game_ctx->frameskip.late &&
+            game_ctx->frameskip.run < GAME_MAX_SKIPPED_FRAMES)
+        {
+            game_ctx->frameskip.skip = true;
+            game_ctx->frameskip.run++;
+            game_ctx->frameskip.lateFrames++;
+        }
+        else if (!game_ctx->frameskip.skip)
+        {
+            game_ctx->frameskip.run = 0;
+        }
+        else
+        {
+            game_ctx->frameskip.turboTicks++;
+        }
+
+#ifdef ENABLE_REPLAY
+        /* record or play back inputs */
+        replay_update();
+#endif /* ENABLE_REPLAY */
+
+        /* frame */
+#ifdef ENABLE_REWIND
+        /* go back one frame instead, for as long as rewind is held */
+        if (!(control_test(Control_REWIND) && !control_test(Control_EXIT) &&
+              game_state == PLAY0 && rewind_step()))
+#endif /* ENABLE_REWIND */
+        {
+            PROFILER_BEGIN(Profiler_FRAME);
+            frame();
+            PROFILER_END(Profiler_FRAME);
+            game_time += game_period;
+#ifdef ENABLE_REWIND
+            if (game_state == PLAY0)
+            {
+                rewind_push();
+            }
+#endif /* ENABLE_REWIND */
+        }
+        game_frames++;  /* as many as pacing and rectangles report */
+        if (game_ctx->frameskip.skip && waitEvents())
+        {
+            /* about to wait for events, e.g. paused: display this tick */
+            game_ctx->frameskip.skip = false;
+            ticks = i + 1;
+        }
+
+        /* video: dirty tiles add up until a tick is displayed */
+        rects_markList(game_rects);
+        if (!game_ctx->frameskip.skip)
+        {
+            /*DEBUG*//*rects_markList(&draw_SCREENRECT);*//*DEBUG*/
+            PROFILER_BEGIN(Profiler_SYSVID_UPDATE);
+            sysvid_update(rects_coalesce(rects_spans()));
+            PROFILER_END(Profiler_SYSVID_UPDATE);
+        }
+
+        /* events */
+        if (waitEvents())
+        {
+            sysevt_wait();  /* wait for an event */
+        }
+        else
+        {
+            PROFILER_BEGIN(Profiler_SYSEVT_POLL);
+            sysevt_poll();  /* process events (non-blocking) */
+            PROFILER_END(Profiler_SYSEVT_POLL);
+        }
+    }
+    game_ctx->frameskip.skip = false;
+
+#ifdef ENABLE_PROFILER
+    profiler_endFrame(frameState, game_submap, game_period);
+#endif /* ENABLE_PROFILER */
+
+    return (game_state != EXIT);
+}
+
+/*
+ * Tear down the game of the current context
+ */
+void
+game_shutdown(void)
+{
 #ifdef ENABLE_SOUND
     syssnd_stopAll();
 #endif
 
-    sys_uncacheData();
+    rects_report();
 
-    resources_unload();
+    draw_shutdown();  /* sysmem is a stack */
+
+#ifdef ENABLE_REWIND
+    rewind_close();
+#endif /* ENABLE_REWIND */
+
+#ifdef ENABLE_REPLAY
+    replay_close();
+#endif /* ENABLE_REPLAY */
+}
+
+/*
+ * Take a snapshot of the game of the current context
+ *
+ * Must be called in between frames, e.g. from the events section.
+ */
+bool
+game_snapshot(game_snapshot_t *snapshot)
+{
+    if (!game_snapshotState(snapshot))
+    {
+        return false;
+    }
+    memcpy(snapshot->fb, sysvid_fb, sizeof(snapshot->fb));
+    return true;
+}
+
+/*
+ * Bring the game of the current context back to a snapshot
+ *
+ * Must be called in between frames. The whole screen is refreshed, with
+ * the game palette.
+ */
+bool
+game_restore(const game_snapshot_t *snapshot)
+{
+    if (!game_restoreState(snapshot))
+    {
+        return false;
+    }
+    memcpy(sysvid_fb, snapshot->fb, sizeof(snapshot->fb));
+#ifdef ENABLE_SAVE_UNDER
+    game_ctx->saveUnder.valid = false;  /* saved from another frame buffer */
+#endif
+#ifdef ENABLE_MAP_LAYER
+    game_ctx->mapLayer.valid = false;  /* drawn from another map */
+#endif
+    sysvid_setGamePalette();
+    sysvid_update(&draw_SCREENRECT);
+    return true;
+}
+
+/*
+ * Copy game state to a snapshot, all but the frame buffer
+ *
+ * Only the first GAME_SNAPSHOT_STATE_SIZE bytes of the snapshot are
+ * written to. Pointers are left out: in between frames they are either
+ * transient (rectangles lists, tiles list, frame buffer cursor) or not
+ * game state.
+ */
+bool
+game_snapshotState(game_snapshot_t *snapshot)
+{
+    const game_context_t *ctx = game_ctx;
+    game_context_t *state = &snapshot->state;
+    size_t i;
+
+    if (map_nbr_marks > GAME_SNAPSHOT_MARKS)
+    {
+        sys_error("(game) too many entity marks for a snapshot");
+        return false;
+    }
+
+    memset(snapshot, 0, GAME_SNAPSHOT_STATE_SIZE);
+    memcpy(snapshot->magic, GAME_SNAPSHOT_MAGIC, sizeof(snapshot->magic));
+    snapshot->size = sizeof(game_snapshot_t);
+
+    state->game = ctx->game;
+    state->game.frames = 0;
+    state->game.rects = NULL;
+#ifdef ENABLE_SOUND
+    state->game.music = NULL;
+#endif
+    state->draw = ctx->draw;
+    state->draw.tllst = NULL;
+    state->draw.fb = NULL;
+    state->draw.statusRect.next = NULL;
+    state->e_bomb = ctx->e_bomb;
+    state->e_bullet = ctx->e_bullet;
+    state->e_rick = ctx->e_rick;
+    state->e_sbonus = ctx->e_sbonus;
+    state->e_them = ctx->e_them;
+    state->ents = ctx->ents;
+    state->maps = ctx->maps;
+    state->maps.marks = NULL;
+    state->screens = ctx->screens;
+    state->screens.highScores = NULL;
+    state->scroller = ctx->scroller;
+
+    for (i = 0; i < map_nbr_marks; i++)
+    {
+        if (map_marks[i].ent & MAP_MARK_NACT)
+        {
+            snapshot->marks[i >> 3] |= 1 << (i & 7);
+        }
+    }
+    return true;
+}
+
+/*
+ * Copy game state back from a snapshot, all but the frame buffer
+ *
+ * Only the first GAME_SNAPSHOT_STATE_SIZE bytes of the snapshot are read.
+ */
+bool
+game_restoreState(const game_snapshot_t *snapshot)
+{
+    const game_context_t *state = &snapshot->state;
+    game_context_t *ctx = game_ctx;
+    U32 frames = ctx->game.frames;
+    const rect_t *rects = ctx->game.rects;
+#ifdef ENABLE_SOUND
+    sound_t *music = ctx->game.music;
+#endif
+    U8 *tllst = ctx->draw.tllst;
+    U8 *fb = ctx->draw.fb;
+    mark_t *marks = ctx->maps.marks;
+    hiscore_t *highScores = ctx->screens.highScores;
+    size_t i;
+
+    if (memcmp(snapshot->magic, GAME_SNAPSHOT_MAGIC, sizeof(snapshot->magic)) ||
+        snapshot->size != sizeof(game_snapshot_t))
+    {
+        sys_error("(game) invalid snapshot");
+        return false;
+    }
+    if (map_nbr_marks > GAME_SNAPSHOT_MARKS)
+    {
+        sys_error("(game) too many entity marks for a snapshot");
+        return false;
+    }
+#ifdef ENABLE_REPLAY
+    if (replay_isActive())
+    {
+        sys_error("(game) can not restore a snapshot while recording or replaying");
+        return false;
+    }
+#endif /* ENABLE_REPLAY */
+
+    ctx->game = state->game;
+    ctx->game.frames = frames;
+    ctx->game.rects = rects;
+#ifdef ENABLE_SOUND
+    ctx->game.music = music;
+#endif
+    ctx->draw = state->draw;
+    ctx->draw.tllst = tllst;
+    ctx->draw.fb = fb;
+    ctx->e_bomb = state->e_bomb;
+    ctx->e_bullet = state->e_bullet;
+    ctx->e_rick = state->e_rick;
+    ctx->e_sbonus = state->e_sbonus;
+    ctx->e_them = state->e_them;
+    ctx->ents = state->ents;
+    ctx->maps = state->maps;
+    ctx->maps.marks = marks;
+    ctx->screens = state->screens;
+    ctx->screens.highScores = highScores;
+    ctx->scroller = state->scroller;
+
+    for (i = 0; i < map_nbr_marks; i++)
+    {
+        if (snapshot->marks[i >> 3] & (1 << (i & 7)))
+        {
+            map_marks[i].ent |= MAP_MARK_NACT;
+        }
+        else
+        {
+            map_marks[i].ent &= ~MAP_MARK_NACT;
+        }
+    }
+    return true;
+}
+
+/*
+ * Write a snapshot of the game of the current context to a file
+ *
+ * The frame buffer goes straight from the context to the file, only the
+ * rest of the snapshot is built in memory.
+ */
+bool
+game_saveSnapshot(const char *name)
+{
+    static const U8 padding[sizeof(void *)] = { 0 };  /* trailing struct padding */
+    const size_t headSize = GAME_SNAPSHOT_STATE_SIZE;
+    const size_t tailSize = sizeof(game_snapshot_t) - headSize - SYSVID_WIDTH * SYSVID_HEIGHT;
+    game_snapshot_t *snapshot;
+    file_t file;
+    bool success;
+
+    snapshot = sysmem_push(headSize);
+    if (!snapshot)
+    {
+        return false;
+    }
+    success = game_snapshotState(snapshot);
+    if (success)
+    {
+        file = sysfile_openLocal(name, true);
+        if (!file)
+        {
+            sys_error("(game) can not create \"%s\"", name);
+            success = false;
+        }
+        else
+        {
+            success = (sysfile_writeLocal(file, snapshot, headSize, 1) == 1 &&
+                       sysfile_writeLocal(file, sysvid_fb, SYSVID_WIDTH * SYSVID_HEIGHT, 1) == 1 &&
+                       (!tailSize || sysfile_writeLocal(file, padding, tailSize, 1) == 1));
+            sysfile_closeLocal(file);
+            if (!success)
+            {
+                sys_error("(game) can not write \"%s\"", name);
+            }
+        }
+    }
+    sysmem_pop(snapshot);
+    return success;
+}
+
+/*
+ * Map a snapshot file in memory and bring the game of the current context
+ * back to it
+ */
+bool
+game_loadSnapshot(const char *name)
+{
+    const game_snapshot_t *snapshot;
+    size_t size;
+    bool success;
+
+    snapshot = sysfile_mapLocal(name, &size);
+    if (!snapshot)
+    {
+        sys_error("(game) can not read \"%s\"", name);
+        return false;
+    }
+    if (size != sizeof(*snapshot))
+    {
+        sys_error("(game) invalid snapshot \"%s\"", name);
+        success = false;
+    }
+    else
+    {
+        success = game_restore(snapshot);
+    }
+    sysfile_unmapLocal(snapshot, size);
+    return success;
+}
+
+/*
+ * Tell whether frames wait for events, rather than poll them
+ */
+static bool
+waitEvents(void)
+{
+#ifdef ENABLE_REPLAY
+    return game_waitevt && !replay_isPlaying();
+#else
+    return game_waitevt;
+#endif /* ENABLE_REPLAY */
+}
+
+/*
+ * Number of ticks to run before displaying a frame
+ *
+ * In turbo mode, the simulation runs several ticks per displayed frame,
+ * drawing only the last one. Turbo is on when asked for on the command
+ * line, or while the turbo control is held.
+ */
+static U8
+turboTicks(void)
+{
+    if (sysarg_args_turbo > 1)
+    {
+        return sysarg_args_turbo;
+    }
+    if (control_test(Control_TURBO))
+    {
+        return GAME_TURBO;
+    }
+    return 1;
+}
+
+#ifdef ENABLE_REPLAY
+/*
+ * Start playback at frame 'target'
+ *
+ * The game goes back to the last keyframe before 'target', then runs the
+ * frames in between as turbo ticks would: not displayed, so that only
+ * the screen is redrawn once there.
+ */
+static bool
+seekReplay(U32 target)
+{
+    if (!replay_seek(target))
+    {
+        return false;
+    }
+    if (game_state == PLAY0)
+    {
+        /* keyframe restored: redraw everything */
+        sysvid_setGamePalette();
+        ent_clprev();
+        draw_map();
+        draw_clearStatus();
+        ent_draw();
+        draw_drawStatus();
+    }
+
+    game_ctx->frameskip.skip = true;
+    while (replay_getFrame() < target && replay_isPlaying() && game_state != EXIT)
+    {
+        replay_update();
+        frame();
+        game_time += game_period;
+    }
+    game_ctx->frameskip.skip = false;
+
+    if (game_state == PLAY0)
+    {
+        ent_clprev();
+        draw_map();
+        draw_clearStatus();
+        ent_draw();
+        draw_drawStatus();
+    }
+    sysvid_update(&draw_SCREENRECT);
+    return true;
 }
+#endif /* ENABLE_REPLAY */
 
 /*
  * Prepare frame
  *
  * This function loops forever: use 'return' when a frame is ready.
- * When returning, game_rects must contain every parts of the buffer
- * that have been modified.
+ * When returning, every part of the buffer that has been modified must
+ * either be in game_rects, or have been marked dirty (see rects.h).
  */
 static void
 frame(void)
 {
     while (1) {
 
+#ifdef ENABLE_PROFILER
+        frameState = game_state;
+#endif
+
         switch (game_state) {
 
 
@@ -649,13 +1284,18 @@ play0(void)
 static void
 play3(void)
 {
-    draw_clearStatus();  /* clear the status bar */
-    ent_draw();          /* draw all entities onto the buffer */
-    /* sound */
-    draw_drawStatus();   /* draw the status bar onto the buffer*/
-
-    game_rects = &draw_STATUSRECT; /* refresh status bar too */
-    draw_STATUSRECT.next = ent_rects;  /* take care to cleanup draw_STATUSRECT->next later! */
+    if (game_ctx->frameskip.skip) {
+        game_rects = NULL;  /* frame not displayed, see game_step */
+    }
+    else {
+        draw_clearStatus();  /* clear the status bar */
+        ent_draw();          /* draw all entities onto the buffer */
+        /* sound */
+        draw_drawStatus();   /* draw the status bar onto the buffer*/
+
+        rects_markList(&draw_STATUSRECT);  /* refresh status bar too */
+        game_rects = NULL;  /* entities marked their own rectangles */
+    }
 
     if (!e_rick_state_test(E_RICK_STZOMBIE)) {  /* need to scroll ? */
         if (ent_ents[1].y >= 0xCC) {
@@ -719,4 +1359,31 @@ irestore(void)
   map_frow = isave_frow;
 }
 
+
+
+/*
+ * Report achieved frame pacing
+ *
+ * Lateness is how long after its deadline a frame started, deviation
+ * is how far the interval between two frames was from game_period.
+ */
+static void
+pacing_report(void)
+{
+  if (!pacing.frames)
+    return;
+
+  sys_printf("xrick/pacing: %u frames, lateness %.3f ms avg %.3f ms max",
+             pacing.frames,
+             pacing.sumLateness / pacing.frames / 1000.0,
+             pacing.maxLateness / 1000.0);
+  if (pacing.intervals)
+    sys_printf(", jitter %.3f ms avg %.3f ms max",
+               pacing.sumDeviation / pacing.intervals / 1000.0,
+               pacing.maxDeviation / 1000.0);
+  sys_printf(", %u resyncs", pacing.resyncs);
+  sys_printf(", %u frames skipped (late), %u ticks skipped (turbo)\n",
+             game_ctx->frameskip.lateFrames, game_ctx->frameskip.turboTicks);
+}
+
 /* eof */
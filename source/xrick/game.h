@@ -18,43 +18,87 @@
 
 #include "xrick/config.h"
 #include "xrick/rects.h"
+#include "xrick/context.h"
 #ifdef ENABLE_SOUND
 #include "xrick/data/sounds.h"
 #endif
 
-#include <stddef.h> /* NULL */
+#include <stddef.h> /* NULL, offsetof */
 
 #define LEFT 1
 #define RIGHT 0
 
 #define GAME_PERIOD 40
+#define GAME_TURBO 8  /* ticks per displayed frame while turbo is held */
 
 #define GAME_BOMBS_INIT 6
 #define GAME_BULLETS_INIT 6
 
-extern U8 game_lives;      /* lives counter */
-extern U8 game_bombs;      /* bombs counter */
-extern U8 game_bullets;    /* bullets counter */
+#define game_lives (game_ctx->game.lives)      /* lives counter */
+#define game_bombs (game_ctx->game.bombs)      /* bombs counter */
+#define game_bullets (game_ctx->game.bullets)  /* bullets counter */
 
-extern U32 game_score;     /* score */
+#define game_score (game_ctx->game.score)      /* score */
 
-extern U16 game_map;       /* current map */
-extern U16 game_submap;    /* current submap */
+#define game_map (game_ctx->game.map)          /* current map */
+#define game_submap (game_ctx->game.submap)    /* current submap */
 
-extern U8 game_dir;        /* direction (LEFT, RIGHT) */
-extern bool game_chsm;       /* change submap request (true, false) */
+#define game_dir (game_ctx->game.dir)          /* direction (LEFT, RIGHT) */
+#define game_chsm (game_ctx->game.chsm)        /* change submap request (true, false) */
 
-extern bool game_waitevt;    /* wait for events (true, false) */
-extern U8 game_period;     /* time between each frame, in millisecond */
+#define game_waitevt (game_ctx->game.waitevt)  /* wait for events (true, false) */
+#define game_period (game_ctx->game.period)    /* time between each frame, in millisecond */
+#define game_time (game_ctx->game.time)        /* game time, i.e. sum of frames periods, in millisecond */
+#define game_frames (game_ctx->game.frames)    /* frames produced so far */
 
-extern const rect_t *game_rects; /* rectangles to redraw at each frame */
+#define game_rects (game_ctx->game.rects)      /* rectangles to redraw at each frame */
+
+#define GAME_SNAPSHOT_MAGIC "XRSS"
+#define GAME_SNAPSHOT_MARKS 0x400  /* entity marks a snapshot can hold */
+
+/*
+ * A snapshot is a flat, fixed size copy of the game state of a context:
+ * game counters, entities (e_rick, e_them... included), map, the
+ * MAP_MARK_NACT bits of entity marks, screens and scroller sequences,
+ * plus the frame buffer. It does not hold any pointer: it can be copied
+ * around with memcpy, written to disk and mapped back in, but only by the
+ * very same build (same layout, same byte order).
+ *
+ * Controls, replay, high scores and frames count are not part of it.
+ */
+typedef struct
+{
+    U8 magic[4];
+    U32 size;                           /* sizeof(game_snapshot_t) */
+    game_context_t state;               /* pointers and other parts are zero */
+    U8 marks[GAME_SNAPSHOT_MARKS / 8];  /* one bit per mark, set when inactive */
+    U8 fb[SYSVID_WIDTH * SYSVID_HEIGHT];
+} game_snapshot_t;
+
+#define GAME_SNAPSHOT_STATE_SIZE offsetof(game_snapshot_t, fb)  /* all but the frame buffer */
 
 extern void game_run(void);
+extern bool game_load(void);
+extern void game_unload(void);
+extern bool game_init(void);
+extern bool game_step(void);
+extern bool game_inPlay(void);
+extern void game_shutdown(void);
+extern bool game_snapshot(game_snapshot_t *);
+extern bool game_restore(const game_snapshot_t *);
+extern bool game_snapshotState(game_snapshot_t *);
+extern bool game_restoreState(const game_snapshot_t *);
+extern bool game_saveSnapshot(const char *);
+extern bool game_loadSnapshot(const char *);
 #ifdef ENABLE_SOUND
 extern void game_setmusic(sound_t * sound, S8 loop);
 extern void game_stopmusic(void);
 #endif /* ENABLE_SOUND */
 
+#define game_cheat1 (game_ctx->game.cheat1)    /* infinite lives, bombs and bullets */
+#define game_cheat2 (game_ctx->game.cheat2)    /* never die */
+#define game_cheat3 (game_ctx->game.cheat3)    /* highlight sprites */
+
 #ifdef ENABLE_CHEATS
 typedef enum
 {
@@ -62,9 +106,6 @@ typedef enum
     Cheat_NEVER_DIE,
     Cheat_EXPOSE
 } cheat_t;
-extern bool game_cheat1;     /* infinite lives, bombs and bullets */
-extern bool game_cheat2;     /* never die */
-extern bool game_cheat3;     /* highlight sprites */
 extern void game_toggleCheat(cheat_t);
 #endif /* ENABLE_CHEATS */
 
@@ -40,11 +40,11 @@
 #include "xrick/screens.h"
 #include "xrick/e_sbonus.h"
 
+#include <string.h> /* memcpy */
+
 /*
  * global vars
  */
-U8 map_map[0x2C][0x20];
-
 size_t map_nbr_maps = 0;
 map_t *map_maps = NULL;
 
@@ -58,23 +58,20 @@ size_t map_nbr_blocks = 0;
 block_t *map_blocks = NULL;
 
 size_t map_nbr_marks = 0;
-mark_t *map_marks = NULL;
 
 size_t map_nbr_bnums = 0;
 U8 *map_bnums = NULL;
 
 size_t map_nbr_eflgc = 0;
 U8 *map_eflg_c = NULL;
-U8 map_eflg[0x100];
-
-U8 map_frow;
-U8 map_tilesBank;
 
 
 /*
  * prototypes
  */
 static void map_eflg_expand(U8);
+static void map_expandRow(U8, U16);
+static U32 map_fgnd_row(U8);
 
 
 /*
@@ -84,31 +81,63 @@ static void map_eflg_expand(U8);
  * We need to /4 map_frow to convert from tile rows to block rows, then
  * we need to *8 to convert from block rows to block numbers (there
  * are 8 blocks per block row). This is achieved by *2 then &0xfff8.
+ *
+ * When map_map already holds this submap from a row close enough to
+ * map_frow, e.g. while scrolling, the ring is moved instead and only the
+ * rows that come in are expanded.
  */
 void
 map_expand(void)
 {
-  U8 i, j, k, l;
-  U8 row, col;
-  U16 pbnum;
-
-  pbnum = map_submaps[game_submap].bnum + ((2 * map_frow) & 0xfff8);
-  row = col = 0;
-
-  for (i = 0; i < 0x0b; i++) {  /* 0x0b rows of blocks */
-    for (j = 0; j < 0x08; j++) {  /* 0x08 blocks per row */
-      for (k = 0, l = 0; k < 0x04; k++) {  /* expand one block */
-    map_map[row][col++] = map_blocks[map_bnums[pbnum]][l++];
-    map_map[row][col++] = map_blocks[map_bnums[pbnum]][l++];
-    map_map[row][col++] = map_blocks[map_bnums[pbnum]][l++];
-    map_map[row][col]   = map_blocks[map_bnums[pbnum]][l++];
-    row += 1; col -= 3;
-      }
-      row -= 4; col += 4;
-      pbnum++;
+  S16 delta = map_frow - game_ctx->maps.expandedFrow;
+  U8 row;
+
+  if (game_ctx->maps.expanded &&
+      game_ctx->maps.expandedSubmap == game_submap &&
+      delta > -MAP_ROWS && delta < MAP_ROWS) {
+    if (delta > 0) {  /* rows come in at the bottom */
+      map_ring = (map_ring + delta) % MAP_ROWS;
+      for (row = MAP_ROWS - delta; row < MAP_ROWS; row++)
+        map_expandRow(row, map_frow + row);
+    }
+    else {  /* at the top */
+      map_ring = (map_ring + MAP_ROWS + delta) % MAP_ROWS;
+      for (row = 0; row < -delta; row++)
+        map_expandRow(row, map_frow + row);
     }
-    row += 4; col = 0;
   }
+  else {
+    for (row = 0; row < MAP_ROWS; row++)  /* 0x0b rows of blocks, from the top */
+      map_expandRow(row, (map_frow & 0xfffc) + row);
+  }
+
+  game_ctx->maps.expanded = true;
+  game_ctx->maps.expandedSubmap = game_submap;
+  game_ctx->maps.expandedFrow = map_frow;
+}
+
+
+/*
+ * Fill in one row of map_map with tile numbers by expanding blocks, four
+ * tiles per block.
+ *
+ * row: row of map_map
+ * srow: row within the submap
+ */
+static void
+map_expandRow(U8 row, U16 srow)
+{
+  U8 *tiles = map_row(row);
+  U16 pbnum;
+  U8 j, l;
+
+  pbnum = map_submaps[game_submap].bnum + ((2 * srow) & 0xfff8);
+  l = (srow & 0x03) * 4;  /* row within the blocks */
+
+  for (j = 0; j < 0x08; j++)  /* 0x08 blocks per row */
+    memcpy(tiles + j * 4, &map_blocks[map_bnums[pbnum + j]][l], 4);
+
+  map_fgnd(row) = map_fgnd_row(row);
 }
 
 
@@ -154,6 +183,23 @@ map_eflg_expand(U8 offs)
 }
 
 
+/*
+ * Foreground tiles of a map_map row, bit n for column n
+ */
+static U32
+map_fgnd_row(U8 row)
+{
+  U32 fgnd = 0;
+  const U8 *tiles = map_row(row);
+  U8 col;
+
+  for (col = 0; col < MAP_COLS; col++)
+    if (map_eflg[tiles[col]] & MAP_EFLG_FGND)
+      fgnd |= (U32)1 << col;
+  return fgnd;
+}
+
+
 /*
  * Chain (sub)maps
  *
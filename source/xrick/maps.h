@@ -36,7 +36,25 @@
 #define MAP_ROW_HBTOP 0x20
 #define MAP_ROW_HBBOT 0x27
 
-extern U8 map_map[0x2c][0x20];
+/*
+ * map_map is a ring of MAP_ROWS rows of MAP_COLS tiles, and map row 0 is
+ * at ring row map_ring: scrolling moves map_ring, then expands the row
+ * that comes in, instead of moving all rows (see map_expand).
+ *
+ * map_tile(row, col): tile at row, col. As with a plain array, columns
+ * past the last one carry on onto the next row.
+ * map_row(row): the MAP_COLS tiles of row.
+ */
+#define MAP_ROWS 0x2c
+#define MAP_COLS 0x20
+
+#define map_map (game_ctx->maps.map)
+#define map_ring (game_ctx->maps.ring)
+
+#define map_index(row, col) \
+  (((unsigned)((row) + map_ring) * MAP_COLS + (col)) % (MAP_ROWS * MAP_COLS))
+#define map_tile(row, col) (map_map[map_index(row, col)])
+#define map_row(row) (&map_map[map_index(row, 0)])
 
 /*
  * main maps
@@ -106,7 +124,7 @@ typedef struct {
 } mark_t;
 
 extern size_t map_nbr_marks;
-extern mark_t *map_marks;
+#define map_marks (game_ctx->maps.marks)
 
 /*
  * block numbers, i.e. array of rows of 8 blocks
@@ -115,7 +133,7 @@ extern size_t map_nbr_bnums;
 extern U8 *map_bnums;
 
 /*
- * flags for map_eflg[map_map[row][col]]  ("yes" when set)
+ * flags for map_eflg[map_tile(row, col)]  ("yes" when set)
  *
  * MAP_EFLG_VERT: vertical move only (usually on top of _CLIMB).
  * MAP_EFLG_SOLID: solid block, can't go through.
@@ -137,17 +155,26 @@ extern U8 *map_bnums;
 
 extern size_t map_nbr_eflgc;
 extern U8 *map_eflg_c;  /* compressed */
-extern U8 map_eflg[0x100];  /* current */
+#define map_eflg (game_ctx->maps.eflg)  /* current */
+
+/*
+ * foreground tiles of map_map, one word per row, bit n set when the tile
+ * in column n has MAP_EFLG_FGND: kept in sync with map_map, it saves
+ * sprites two lookups per tile they cover
+ */
+#define map_fgnd(row) (game_ctx->maps.fgnd[((unsigned)(row) + map_ring) % MAP_ROWS])
 
 /*
  * map_map top row within the submap
  */
-extern U8 map_frow;
+#define map_frow (game_ctx->maps.frow)
 
 /*
  * tiles offset
  */
-extern U8 map_tilesBank;
+#define map_tilesBank (game_ctx->maps.tilesBank)
+
+#include "xrick/context.h"
 
 extern void map_expand(void);
 extern void map_init(void);
@@ -0,0 +1,320 @@
+/*
+ * xrick/profiler.c
+ *
+ * Copyright (C) 2008-2014 Pierluigi Vicinanza. All rights reserved.
+ *
+ * The use and distribution terms for this software are contained in the file
+ * named README, which can be found in the root of this distribution. By
+ * using this software in any fashion, you are agreeing to be bound by the
+ * terms of this license.
+ *
+ * You must not remove this notice, or any other, from this software.
+ */
+
+#include "xrick/config.h"
+
+#ifdef ENABLE_PROFILER
+
+#include "xrick/profiler.h"
+
+#include "xrick/system/system.h"
+
+#include <string.h> /* memset */
+
+/*
+ * local typedefs
+ */
+
+/*
+ * Latency distribution, HdrHistogram style: values below
+ * 2 * PROFILER_SUB_BUCKETS are counted exactly, then every power of two
+ * is split into PROFILER_SUB_BUCKETS linear buckets.
+ */
+typedef struct
+{
+    U32 count;
+    U32 overruns;
+    U32 min;
+    U32 max;
+    double sum;
+    U32 buckets[PROFILER_BUCKETS];
+} histogram_t;
+
+/*
+ * local vars
+ */
+static bool enabled = false;
+static const char * const *stateNames = NULL;
+static U8 statesCount = 0;
+static U32 frames = 0;
+static U32 overruns = 0;
+
+static U32 phaseStart[Profiler_PHASES_COUNT];
+static U32 phaseTime[Profiler_PHASES_COUNT];   /* this frame, in microseconds */
+static U8 phaseCalls[Profiler_PHASES_COUNT];   /* this frame */
+
+static histogram_t histograms[PROFILER_MAX_STATES][Profiler_PHASES_COUNT];
+
+static const char *phaseNames[Profiler_PHASES_COUNT] =
+{
+    "total", "frame", "ent_action", "ent_draw", "draw_drawStatus",
+    "sysvid_update", "sysevt_poll"
+};
+
+/*
+ * prototypes
+ */
+static void record(histogram_t *, U32);
+static U32 percentile(const histogram_t *, double);
+static U16 toIndex(U32);
+static U32 fromIndex(U16);
+
+/*
+ * Enable profiling, when requested by command line arguments.
+ */
+bool
+profiler_init(const char * const *names, U8 count)
+{
+    U8 i;
+    U8 p;
+
+    if (!sysarg_args_profile)
+    {
+        return true;
+    }
+    if (count > PROFILER_MAX_STATES)
+    {
+        sys_error("(profiler) too many game states");
+        return false;
+    }
+
+    stateNames = names;
+    statesCount = count;
+    frames = 0;
+    overruns = 0;
+    for (i = 0; i < count; ++i)
+    {
+        for (p = 0; p < Profiler_PHASES_COUNT; ++p)
+        {
+            histograms[i][p].count = 0;
+            histograms[i][p].overruns = 0;
+            histograms[i][p].min = PROFILER_MAX_VALUE;
+            histograms[i][p].max = 0;
+            histograms[i][p].sum = 0;
+            memset(histograms[i][p].buckets, 0, sizeof(histograms[i][p].buckets));
+        }
+    }
+    for (p = 0; p < Profiler_PHASES_COUNT; ++p)
+    {
+        phaseTime[p] = 0;
+        phaseCalls[p] = 0;
+    }
+    enabled = true;
+    return true;
+}
+
+/*
+ * Dump histograms to CSV file, one line per game state and phase.
+ */
+void
+profiler_shutdown(void)
+{
+    file_t file;
+    char line[256];
+    U8 i;
+    U8 p;
+
+    if (!enabled)
+    {
+        return;
+    }
+    enabled = false;
+
+    sys_printf("xrick/profiler: %u frames, %u overruns\n", frames, overruns);
+
+    file = sysfile_openLocal(sysarg_args_profile, true);
+    if (!file)
+    {
+        sys_error("(profiler) can not create \"%s\"", sysarg_args_profile);
+        return;
+    }
+
+    sys_snprintf(line, sizeof(line),
+                 "state,phase,count,overruns,min_us,mean_us,p50_us,p90_us,p99_us,p999_us,max_us\n");
+    sysfile_writeLocal(file, line, sys_strlen(line), 1);
+
+    for (i = 0; i < statesCount; ++i)
+    {
+        for (p = 0; p < Profiler_PHASES_COUNT; ++p)
+        {
+            const histogram_t *h = &histograms[i][p];
+            if (!h->count)
+            {
+                continue;
+            }
+            sys_snprintf(line, sizeof(line),
+                         "%s,%s,%u,%u,%u,%.1f,%u,%u,%u,%u,%u\n",
+                         stateNames[i], phaseNames[p], h->count, h->overruns,
+                         h->min, h->sum / h->count,
+                         percentile(h, 50.0), percentile(h, 90.0),
+                         percentile(h, 99.0), percentile(h, 99.9), h->max);
+            if (sysfile_writeLocal(file, line, sys_strlen(line), 1) != 1)
+            {
+                sys_error("(profiler) can not write \"%s\"", sysarg_args_profile);
+                sysfile_closeLocal(file);
+                return;
+            }
+        }
+    }
+
+    sysfile_closeLocal(file);
+}
+
+/*
+ * Phases may be entered several times per frame (e.g. ent_draw when
+ * scrolling), their times add up.
+ */
+void
+profiler_begin(profiler_phase_t phase)
+{
+    if (enabled)
+    {
+        phaseStart[phase] = sys_gettimeUs();
+    }
+}
+
+void
+profiler_end(profiler_phase_t phase)
+{
+    if (enabled)
+    {
+        phaseTime[phase] += sys_gettimeUs() - phaseStart[phase];
+        phaseCalls[phase]++;
+    }
+}
+
+/*
+ * Record this frame's phases against the game state that produced it,
+ * and report the frame when it took longer than its period.
+ *
+ * Total is the sum of frame, video and events phases, so that time spent
+ * waiting for events (pause) is not accounted for.
+ */
+void
+profiler_endFrame(U8 state, U16 submap, U8 period)
+{
+    U32 total;
+    U8 p;
+
+    if (!enabled || state >= statesCount)
+    {
+        return;
+    }
+
+    total = phaseTime[Profiler_FRAME] + phaseTime[Profiler_SYSVID_UPDATE] +
+        phaseTime[Profiler_SYSEVT_POLL];
+    record(&histograms[state][Profiler_TOTAL], total);
+
+    if (total > (U32)period * 1000)
+    {
+        histograms[state][Profiler_TOTAL].overruns++;
+        overruns++;
+        sys_printf("xrick/profiler: frame %u overrun, %u us > %u ms (state %s, submap %u)\n",
+                   frames, total, period, stateNames[state], submap);
+    }
+
+    for (p = Profiler_FRAME; p < Profiler_PHASES_COUNT; ++p)
+    {
+        if (phaseCalls[p])
+        {
+            record(&histograms[state][p], phaseTime[p]);
+        }
+        phaseTime[p] = 0;
+        phaseCalls[p] = 0;
+    }
+    frames++;
+}
+
+/*
+ *
+ */
+static void
+record(histogram_t *h, U32 value)
+{
+    if (value > PROFILER_MAX_VALUE)
+    {
+        value = PROFILER_MAX_VALUE;
+    }
+    h->buckets[toIndex(value)]++;
+    h->count++;
+    h->sum += value;
+    if (value < h->min)
+    {
+        h->min = value;
+    }
+    if (value > h->max)
+    {
+        h->max = value;
+    }
+}
+
+/*
+ * Return highest value equivalent to the given percentile.
+ */
+static U32
+percentile(const histogram_t *h, double percent)
+{
+    U32 target = (U32)(h->count * percent / 100.0 + 0.5);
+    U32 total = 0;
+    U16 i;
+
+    if (target < 1)
+    {
+        target = 1;
+    }
+    for (i = 0; i < PROFILER_BUCKETS; ++i)
+    {
+        total += h->buckets[i];
+        if (total >= target)
+        {
+            U32 value = fromIndex(i + 1) - 1;
+            return value > h->max ? h->max : value;
+        }
+    }
+    return h->max;
+}
+
+/*
+ * Value to bucket index.
+ */
+static U16
+toIndex(U32 value)
+{
+    U8 shift = 0;
+
+    while ((value >> shift) >= 2 * PROFILER_SUB_BUCKETS)
+    {
+        shift++;
+    }
+    return (U16)(shift * PROFILER_SUB_BUCKETS + (value >> shift));
+}
+
+/*
+ * Bucket index to lowest value in bucket.
+ */
+static U32
+fromIndex(U16 index)
+{
+    U8 shift;
+
+    if (index < 2 * PROFILER_SUB_BUCKETS)
+    {
+        return index;
+    }
+    shift = index / PROFILER_SUB_BUCKETS - 1;
+    return (U32)(index - shift * PROFILER_SUB_BUCKETS) << shift;
+}
+
+#endif /* ENABLE_PROFILER */
+
+/* eof */
@@ -0,0 +1,57 @@
+/*
+ * xrick/profiler.h
+ *
+ * Copyright (C) 2008-2014 Pierluigi Vicinanza. All rights reserved.
+ *
+ * The use and distribution terms for this software are contained in the file
+ * named README, which can be found in the root of this distribution. By
+ * using this software in any fashion, you are agreeing to be bound by the
+ * terms of this license.
+ *
+ * You must not remove this notice, or any other, from this software.
+ */
+
+#ifndef _PROFILER_H
+#define _PROFILER_H
+
+#include "xrick/config.h"
+#include "xrick/system/basic_types.h"
+
+typedef enum
+{
+    Profiler_TOTAL,          /* frame + video + events */
+    Profiler_FRAME,          /* game state machine */
+    Profiler_ENT_ACTION,
+    Profiler_ENT_DRAW,
+    Profiler_DRAW_STATUS,
+    Profiler_SYSVID_UPDATE,
+    Profiler_SYSEVT_POLL,
+    Profiler_PHASES_COUNT
+} profiler_phase_t;
+
+#ifdef ENABLE_PROFILER
+
+#define PROFILER_MAX_STATES 32
+#define PROFILER_SUB_BUCKETS 16   /* per power of two, i.e. ~6% precision */
+#define PROFILER_MAX_VALUE ((1 << 20) - 1)  /* in microseconds, higher values are clamped */
+#define PROFILER_BUCKETS (17 * PROFILER_SUB_BUCKETS)  /* enough for PROFILER_MAX_VALUE */
+
+extern bool profiler_init(const char * const *, U8);
+extern void profiler_shutdown(void);
+extern void profiler_begin(profiler_phase_t);
+extern void profiler_end(profiler_phase_t);
+extern void profiler_endFrame(U8, U16, U8);
+
+#define PROFILER_BEGIN(X) profiler_begin(X)
+#define PROFILER_END(X) profiler_end(X)
+
+#else
+
+#define PROFILER_BEGIN(X)
+#define PROFILER_END(X)
+
+#endif /* ENABLE_PROFILER */
+
+#endif /* ndef _PROFILER_H */
+
+/* eof */
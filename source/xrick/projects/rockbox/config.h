@@ -38,6 +38,43 @@
 /* development tools */
 #undef ENABLE_DEVTOOLS
 
+/* inputs recording and replay */
+#undef ENABLE_REPLAY
+
+/* rewind, i.e. stepping back through the last frames of play */
+#undef ENABLE_REWIND
+
+/* decoded tiles cache, of TILES_CACHE_SLOTS tiles per game (least recently
+ * used tiles go first), or of all tiles, shared, when TILES_CACHE_SLOTS is 0 */
+#define ENABLE_TILES_CACHE
+#define TILES_CACHE_SLOTS 64
+
+/* decoded sprites cache, shared (GFXST), or pre-shifted sprites cache of
+ * SPRITES_CACHE_BUDGET KiB per game (GFXPC, least recently used go first) */
+#undef ENABLE_SPRITES_CACHE
+#define SPRITES_CACHE_BUDGET 16
+
+/* save-under buffers: entities are erased by putting back what was under
+ * their sprites, instead of redrawing the map */
+#define ENABLE_SAVE_UNDER
+
+/* map layer: a copy of the map screen background, drawn along with the map,
+ * that entities and the status bar are erased from instead of redrawing tiles */
+#undef ENABLE_MAP_LAYER
+
+/* cost of a screen update call, in pixels copied: screen rectangles merge
+ * when copying a few more pixels is cheaper than one more call */
+#define RECTS_CALL_COST 4096
+
+/* frame timing profiler */
+#undef ENABLE_PROFILER
+
+/* parallel game instances */
+#undef ENABLE_THREADS
+
+/* frames presented by a separate thread, from a second frame buffer (SDL only) */
+#undef ENABLE_PRESENTER
+
 /* Print debug info to screen */
 #undef ENABLE_SYSPRINTF_TO_SCREEN
 
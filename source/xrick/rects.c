@@ -14,44 +14,324 @@
  */
 
 #include "xrick/rects.h"
-#include "xrick/system/system.h"
+#include "xrick/config.h"
+#include "xrick/context.h"
+
+#include <string.h> /* memset */
+
+/*
+ * prototypes
+ */
+static bool isDirty(U8, U8);
+static U8 buildSpans(bool);
+static void boundingBox(const rect_t *, const rect_t *, rect_t *);
+static U32 area(const rect_t *);
 
 /*
- * Free a list of rectangles and set the pointer to NULL.
+ * Mark the tiles a rectangle covers as dirty, clipped to the frame buffer
  *
- * p: rectangle list CHANGED to NULL
+ * x, y, width, height: rectangle (pixels, screen)
+ */
+void
+rects_mark(U16 x, U16 y, U16 width, U16 height)
+{
+    U16 c0, c1, r0, r1, r, w;  /* first and last (excluded) tiles */
+    U32 mask[RECTS_WORDS];
+
+    if (!width || !height)
+    {
+        return;
+    }
+
+    c0 = x >> 3;
+    c1 = (x + width + 7) >> 3;
+    if (c1 > RECTS_COLS)
+    {
+        c1 = RECTS_COLS;
+    }
+    r0 = y >> 3;
+    r1 = (y + height + 7) >> 3;
+    if (r1 > RECTS_ROWS)
+    {
+        r1 = RECTS_ROWS;
+    }
+
+    if (c0 >= c1 || r0 >= r1)
+    {
+        return;
+    }
+
+    /* columns c0 to c1 (excluded), word by word */
+    for (w = 0; w < RECTS_WORDS; w++)
+    {
+        S16 lo = c0 - w * 32;
+        S16 hi = c1 - w * 32;
+        if (lo < 0)
+        {
+            lo = 0;
+        }
+        if (hi > 32)
+        {
+            hi = 32;
+        }
+        mask[w] = (lo < hi) ? (0xffffffffU >> (32 - (hi - lo))) << lo : 0;
+    }
+    for (r = r0; r < r1; r++)
+    {
+        for (w = 0; w < RECTS_WORDS; w++)
+        {
+            game_ctx->rects.dirty[r][w] |= mask[w];
+        }
+    }
+}
+
+
+/*
+ * Mark the tiles of a list of rectangles as dirty
  */
 void
-rects_free(rect_t *r)
+rects_markList(const rect_t *r)
+{
+    for (; r; r = r->next)
+    {
+        rects_mark(r->x, r->y, r->width, r->height);
+    }
+}
+
+
+/*
+ * Turn dirty tiles into a list of rectangles, and clear them
+ *
+ * Runs of dirty tiles on a row make rectangles, which grow downwards for
+ * as long as rows below have the exact same run. Would that make more
+ * than RECTS_MAX_SPANS rectangles, each row makes a single run from its
+ * first to its last dirty tile instead.
+ *
+ * return: list of rectangles, valid until next call, or NULL if no tile
+ * is dirty
+ */
+rect_t *
+rects_spans(void)
 {
-    while (r)
+    U8 n;
+
+    n = buildSpans(false);
+    if (n > RECTS_MAX_SPANS)
     {
-        rect_t * next = r->next;
-        sysmem_pop(r);
-        r = next;
+        n = buildSpans(true);
     }
+    memset(game_ctx->rects.dirty, 0, sizeof(game_ctx->rects.dirty));
+    return n ? game_ctx->rects.spans : NULL;
 }
 
 
 /*
- * Add a rectangle to a list of rectangles
+ * Merge rectangles of a list, when copying more pixels is cheaper than
+ * one more update call
+ *
+ * Update calls cost RECTS_CALL_COST, in pixels copied: two rectangles
+ * merge into their bounding box when it has less than RECTS_CALL_COST
+ * pixels more than they have together, best merge first. Adjacent and
+ * overlapping rectangles thus merge as long as their bounding box wastes
+ * few pixels. The list collapses to the whole screen once that is cheaper
+ * than what is left.
+ *
+ * return: merged list, made of nodes of the given list
  */
 rect_t *
-rects_new(U16 x, U16 y, U16 width, U16 height, rect_t *next)
+rects_coalesce(rect_t *rects)
 {
-    rect_t *r;
+    rect_t *a, *b, *prev, *bestA, *bestPrev;
+    rect_t box;
+    S32 gain, bestGain;
+    U32 pixels, n;
 
-    r = sysmem_push(sizeof(*r));
-    if (!r)
+    game_ctx->rects.frames++;
+    if (!rects)
     {
         return NULL;
     }
-    r->x = x;
-    r->y = y;
-    r->width = width;
-    r->height = height;
-    r->next = next;
-    return r;
+    for (a = rects, n = 0, pixels = 0; a; a = a->next, n++)
+    {
+        pixels += area(a);
+    }
+    game_ctx->rects.rectsIn += n;
+    game_ctx->rects.pixelsIn += pixels;
+
+    do
+    {
+        bestGain = 0;
+        bestA = bestPrev = NULL;
+        for (a = rects; a; a = a->next)
+        {
+            for (prev = a, b = a->next; b; prev = b, b = b->next)
+            {
+                boundingBox(a, b, &box);
+                gain = RECTS_CALL_COST + (S32)(area(a) + area(b)) - (S32)area(&box);
+                if (gain > bestGain)
+                {
+                    bestGain = gain;
+                    bestA = a;
+                    bestPrev = prev;
+                }
+            }
+        }
+        if (bestA)
+        {
+            b = bestPrev->next;
+            boundingBox(bestA, b, bestA);
+            bestPrev->next = b->next;
+        }
+    }
+    while (bestA);
+
+    for (a = rects, n = 0, pixels = 0; a; a = a->next, n++)
+    {
+        pixels += area(a);
+    }
+    if (pixels + (n - 1) * RECTS_CALL_COST >= RECTS_COLS * 8 * RECTS_ROWS * 8)
+    {
+        rects->x = 0;
+        rects->y = 0;
+        rects->width = RECTS_COLS * 8;
+        rects->height = RECTS_ROWS * 8;
+        rects->next = NULL;
+        n = 1;
+        pixels = area(rects);
+    }
+    game_ctx->rects.rectsOut += n;
+    game_ctx->rects.pixelsOut += pixels;
+    return rects;
+}
+
+
+/*
+ * Report what rectangles merging saved, per displayed frame
+ */
+void
+rects_report(void)
+{
+    U32 frames = game_ctx->rects.frames;
+
+    if (!frames)
+    {
+        return;
+    }
+    sys_printf("xrick/rects: %u frames displayed, per frame %.0f pixels in %.2f rectangles,"
+               " %.0f pixels in %.2f rectangles once merged\n",
+               frames,
+               game_ctx->rects.pixelsIn / frames, (double)game_ctx->rects.rectsIn / frames,
+               game_ctx->rects.pixelsOut / frames, (double)game_ctx->rects.rectsOut / frames);
+}
+
+
+/*
+ * Build the list of rectangles
+ *
+ * rowBounds: one run per row
+ * return: number of rectangles, RECTS_MAX_SPANS + 1 when out of room
+ */
+static U8
+buildSpans(bool rowBounds)
+{
+    rect_t *spans = game_ctx->rects.spans;
+    U8 n = 0;
+    U8 r, c, c0, i;
+
+    for (r = 0; r < RECTS_ROWS; r++)
+    {
+        for (c = 0; c < RECTS_COLS; c++)
+        {
+            if (!(c & 31) && !game_ctx->rects.dirty[r][c >> 5])
+            {
+                c += 31;  /* whole word is clean */
+                continue;
+            }
+            if (!isDirty(r, c))
+            {
+                continue;
+            }
+            c0 = c;
+            while (c < RECTS_COLS && isDirty(r, c))
+            {
+                c++;
+            }
+            if (rowBounds)
+            {
+                U8 k;
+                for (k = c; k < RECTS_COLS; k++)
+                {
+                    if (isDirty(r, k))
+                    {
+                        c = k + 1;
+                    }
+                }
+            }
+
+            /* same run right above: grow downwards */
+            for (i = 0; i < n; i++)
+            {
+                if (spans[i].x == c0 * 8 && spans[i].width == (c - c0) * 8 &&
+                    spans[i].y + spans[i].height == r * 8)
+                {
+                    spans[i].height += 8;
+                    break;
+                }
+            }
+            if (i < n)
+            {
+                continue;
+            }
+
+            if (n == RECTS_MAX_SPANS)
+            {
+                return RECTS_MAX_SPANS + 1;
+            }
+            spans[n].x = c0 * 8;
+            spans[n].y = r * 8;
+            spans[n].width = (c - c0) * 8;
+            spans[n].height = 8;
+            spans[n].next = NULL;
+            if (n)
+            {
+                spans[n - 1].next = &spans[n];
+            }
+            n++;
+        }
+    }
+    return n;
+}
+
+
+static bool
+isDirty(U8 r, U8 c)
+{
+    return (game_ctx->rects.dirty[r][c >> 5] >> (c & 31)) & 1;
+}
+
+
+/*
+ * Bounding box of two rectangles, box may be one of them
+ */
+static void
+boundingBox(const rect_t *a, const rect_t *b, rect_t *box)
+{
+    U16 x0 = (a->x < b->x) ? a->x : b->x;
+    U16 y0 = (a->y < b->y) ? a->y : b->y;
+    U16 x1 = (a->x + a->width > b->x + b->width) ? a->x + a->width : b->x + b->width;
+    U16 y1 = (a->y + a->height > b->y + b->height) ? a->y + a->height : b->y + b->height;
+
+    box->x = x0;
+    box->y = y0;
+    box->width = x1 - x0;
+    box->height = y1 - y0;
+}
+
+
+static U32
+area(const rect_t *r)
+{
+    return (U32)r->width * r->height;
 }
 
 /* eof */
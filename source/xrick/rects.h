@@ -24,8 +24,22 @@ typedef struct rect_s {
   struct rect_s *next;
 } rect_t;
 
-extern void rects_free(rect_t *);
-extern rect_t *rects_new(U16, U16, U16, U16, rect_t *);
+/*
+ * Parts of the frame buffer to refresh are kept as a bitmap of dirty
+ * tiles, one bit per 8x8 pixels tile of the SYSVID_WIDTH x SYSVID_HEIGHT
+ * frame buffer. When it is time to refresh, dirty tiles turn into at most
+ * RECTS_MAX_SPANS rectangles.
+ */
+#define RECTS_COLS 40  /* SYSVID_WIDTH / 8 */
+#define RECTS_ROWS 25  /* SYSVID_HEIGHT / 8 */
+#define RECTS_WORDS ((RECTS_COLS + 31) / 32)  /* per row */
+#define RECTS_MAX_SPANS 32  /* RECTS_ROWS at least */
+
+extern void rects_mark(U16, U16, U16, U16);
+extern void rects_markList(const rect_t *);
+extern rect_t *rects_spans(void);
+extern rect_t *rects_coalesce(rect_t *);
+extern void rects_report(void);
 
 #endif /* ndef _RECTS_H */
 
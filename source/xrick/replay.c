@@ -0,0 +1,617 @@
+/*
+ * xrick/replay.c
+ *
+ * Copyright (C) 2008-2014 Pierluigi Vicinanza. All rights reserved.
+ *
+ * The use and distribution terms for this software are contained in the file
+ * named README, which can be found in the root of this distribution. By
+ * using this software in any fashion, you are agreeing to be bound by the
+ * terms of this license.
+ *
+ * You must not remove this notice, or any other, from this software.
+ */
+
+#include "xrick/config.h"
+
+#ifdef ENABLE_REPLAY
+
+#include "xrick/replay.h"
+
+#include "xrick/game.h"
+#include "xrick/control.h"
+#include "xrick/e_them.h"
+#include "xrick/system/system.h"
+#include "xrick/system/basic_funcs.h"
+
+#include <stdio.h>  /* SEEK_SET */
+#include <string.h> /* memcpy, memcmp, memset */
+
+#define REPLAY_MAGIC "XRPL"
+#define REPLAY_RUN_MAXSIZE 15  /* three 32 bits variable length integers */
+
+/*
+ * local typedefs
+ */
+typedef enum
+{
+    Replay_OFF,
+    Replay_RECORD,
+    Replay_PLAY
+} replay_mode_t;
+
+/*
+ * prototypes
+ */
+static bool openRecord(void);
+static bool openPlay(void);
+static void record(void);
+static void play(void);
+static void flushRun(void);
+static bool decodeRun(void);
+static U32 getInputs(void);
+static void setInputs(U32);
+static void putVarint(U32);
+static U32 getVarint(void);
+static void putU16(U8 *, U16);
+static void putU32(U8 *, U32);
+static U16 getU16(const U8 *);
+static U32 getU32(const U8 *);
+
+/*
+ * Start recording, or playing back, as requested by command line arguments.
+ *
+ * Must be called before game_period and map/submap arguments are used,
+ * since playback overrides them with the recorded ones.
+ */
+bool
+replay_open(void)
+{
+    game_ctx->replay.frame = 0;
+    game_ctx->replay.offset = 0;
+    game_ctx->replay.runLength = 0;
+    game_ctx->replay.desync = false;
+    game_ctx->replay.stopped = false;
+    game_ctx->replay.seed = e_them_rndseed;
+
+    if (sysarg_args_replay)
+    {
+        return openPlay();
+    }
+    if (sysarg_args_record)
+    {
+        return openRecord();
+    }
+    return true;
+}
+
+/*
+ * Stop recording, or playing back. Recorded data is written to file.
+ */
+void
+replay_close(void)
+{
+    replay_header_t header;
+    U32 i;
+
+    if (game_ctx->replay.mode == Replay_RECORD)
+    {
+        flushRun();
+
+        memcpy(header.magic, REPLAY_MAGIC, sizeof(header.magic));
+        putU16(header.version, REPLAY_VERSION);
+        putU16(header.interval, REPLAY_KEYFRAME_INTERVAL);
+        putU16(header.period, sysarg_args_period);
+        putU16(header.map, sysarg_args_map);
+        putU16(header.submap, sysarg_args_submap);
+        putU16(header.snapshot, (U16)game_ctx->replay.snapshotSize);
+        putU32(header.frames, game_ctx->replay.framesCount);
+        putU32(header.keyframes, game_ctx->replay.keyframesCount);
+        putU32(header.size, game_ctx->replay.streamSize);
+
+        /* snapshots are in the file already, keyframes table grows
+         * downwards from the end of the buffer */
+        for (i = 0; i < game_ctx->replay.keyframesCount; ++i)
+        {
+            if (sysfile_writeLocal(game_ctx->replay.file, &game_ctx->replay.keyframes[-(int)i],
+                                   sizeof(replay_keyframe_t), 1) != 1)
+            {
+                sys_error("(replay) can not write \"%s\"", sysarg_args_record);
+                break;
+            }
+        }
+        if (game_ctx->replay.streamSize &&
+            sysfile_writeLocal(game_ctx->replay.file, game_ctx->replay.stream,
+                               game_ctx->replay.streamSize, 1) != 1)
+        {
+            sys_error("(replay) can not write \"%s\"", sysarg_args_record);
+        }
+        if (sysfile_seekLocal(game_ctx->replay.file, 0, SEEK_SET) != 0 ||
+            sysfile_writeLocal(game_ctx->replay.file, &header, sizeof(header), 1) != 1)
+        {
+            sys_error("(replay) can not write \"%s\"", sysarg_args_record);
+        }
+        sys_printf("xrick/replay: recorded %u frames, %u bytes\n",
+                   game_ctx->replay.framesCount, game_ctx->replay.streamSize);
+    }
+    else if (game_ctx->replay.mode == Replay_PLAY)
+    {
+        sys_printf("xrick/replay: played back %u frames out of %u%s\n",
+                   game_ctx->replay.frame, game_ctx->replay.framesCount,
+                   game_ctx->replay.desync ? " (desynchronized)" : "");
+    }
+
+    if (game_ctx->replay.file)
+    {
+        sysfile_closeLocal(game_ctx->replay.file);
+        game_ctx->replay.file = NULL;
+    }
+    if (game_ctx->replay.buffer)
+    {
+        sysmem_pop(game_ctx->replay.buffer);
+        game_ctx->replay.buffer = NULL;
+    }
+    game_ctx->replay.mode = Replay_OFF;
+    game_ctx->replay.stopped = false;
+}
+
+/*
+ * Record inputs for the coming frame, or override them with played back ones.
+ *
+ * Must be called right before each frame.
+ *
+ * Once the recording buffer is full, or the stream played back entirely,
+ * the replay stops but its buffer is kept until replay_close, so that
+ * memory is released in reverse allocation order.
+ */
+void
+replay_update(void)
+{
+    if (game_ctx->replay.stopped)
+    {
+        return;
+    }
+    if (game_ctx->replay.mode == Replay_RECORD)
+    {
+        record();
+    }
+    else if (game_ctx->replay.mode == Replay_PLAY)
+    {
+        play();
+    }
+}
+
+/*
+ * Bring the game back to the last keyframe at or before frame 'target',
+ * and position playback right before the keyframe frame. The frames from
+ * there to 'target' are left to the caller to run.
+ *
+ * Must be called right after replay_open. When 'target' comes before the
+ * first keyframe, playback stays at the start.
+ */
+bool
+replay_seek(U32 target)
+{
+    const replay_keyframe_t *keyframe = NULL;
+    game_snapshot_t *snapshot;
+    U32 k;
+    bool success;
+
+    if (game_ctx->replay.mode != Replay_PLAY || target > game_ctx->replay.framesCount)
+    {
+        sys_error("(replay) can not seek to frame %u of \"%s\"", target, sysarg_args_replay);
+        return false;
+    }
+    if (game_ctx->replay.snapshotSize != GAME_SNAPSHOT_STATE_SIZE)
+    {
+        sys_error("(replay) can not seek \"%s\", written by another build", sysarg_args_replay);
+        return false;
+    }
+
+    for (k = 0; k < game_ctx->replay.keyframesCount &&
+                getU32(game_ctx->replay.keyframes[k].frame) <= target; ++k)
+    {
+        keyframe = &game_ctx->replay.keyframes[k];
+    }
+    if (!keyframe)
+    {
+        return true;
+    }
+
+    snapshot = sysmem_push(GAME_SNAPSHOT_STATE_SIZE);
+    if (!snapshot)
+    {
+        return false;
+    }
+    success = (sysfile_seekLocal(game_ctx->replay.file, getU32(keyframe->snapshot), SEEK_SET) == 0 &&
+               sysfile_readLocal(game_ctx->replay.file, snapshot, GAME_SNAPSHOT_STATE_SIZE, 1) == 1);
+    if (!success)
+    {
+        sys_error("(replay) \"%s\" is truncated", sysarg_args_replay);
+    }
+    else
+    {
+        /* game_restoreState refuses to run while replaying */
+        game_ctx->replay.stopped = true;
+        success = game_restoreState(snapshot);
+        game_ctx->replay.stopped = false;
+    }
+    sysmem_pop(snapshot);
+    if (!success)
+    {
+        return false;
+    }
+
+    game_ctx->replay.frame = getU32(keyframe->frame);
+    game_ctx->replay.offset = getU32(keyframe->offset);
+    game_ctx->replay.seed = getU32(keyframe->seed);
+    game_ctx->replay.runLength = 0;
+    return true;
+}
+
+/*
+ * Tell which frame comes next, counting from the start of the replay
+ */
+U32
+replay_getFrame(void)
+{
+    return game_ctx->replay.frame;
+}
+
+/*
+ *
+ */
+bool
+replay_isPlaying(void)
+{
+    return (game_ctx->replay.mode == Replay_PLAY && !game_ctx->replay.stopped);
+}
+
+/*
+ * Tell whether inputs are being recorded or played back
+ */
+bool
+replay_isActive(void)
+{
+    return (game_ctx->replay.mode != Replay_OFF && !game_ctx->replay.stopped);
+}
+
+/*
+ * Allocate recording buffer and create replay file.
+ */
+static bool
+openRecord(void)
+{
+    replay_header_t header;
+
+    game_ctx->replay.file = sysfile_openLocal(sysarg_args_record, true);
+    if (!game_ctx->replay.file)
+    {
+        sys_error("(replay) can not create \"%s\"", sysarg_args_record);
+        return false;
+    }
+
+    /* header goes first once complete, snapshots follow as they are taken */
+    memset(&header, 0, sizeof(header));
+    if (sysfile_writeLocal(game_ctx->replay.file, &header, sizeof(header), 1) != 1)
+    {
+        sys_error("(replay) can not write \"%s\"", sysarg_args_record);
+        return false;
+    }
+
+    game_ctx->replay.buffer = sysmem_push(GAME_SNAPSHOT_STATE_SIZE + REPLAY_BUFFER_SIZE);
+    if (!game_ctx->replay.buffer)
+    {
+        return false;
+    }
+    game_ctx->replay.snapshot = game_ctx->replay.buffer;
+    game_ctx->replay.stream = game_ctx->replay.buffer + GAME_SNAPSHOT_STATE_SIZE;
+    game_ctx->replay.keyframes =
+        (replay_keyframe_t *)(game_ctx->replay.stream + REPLAY_BUFFER_SIZE) - 1;
+    game_ctx->replay.streamSize = 0;
+    game_ctx->replay.keyframesCount = 0;
+    game_ctx->replay.nextKeyframe = 0;
+    game_ctx->replay.snapshotSize = GAME_SNAPSHOT_STATE_SIZE;
+    game_ctx->replay.framesCount = 0;
+
+    game_ctx->replay.mode = Replay_RECORD;
+    return true;
+}
+
+/*
+ * Load replay file, and restore recorded arguments.
+ */
+static bool
+openPlay(void)
+{
+    replay_header_t header;
+    size_t tableSize;
+
+    game_ctx->replay.file = sysfile_openLocal(sysarg_args_replay, false);
+    if (!game_ctx->replay.file)
+    {
+        sys_error("(replay) can not open \"%s\"", sysarg_args_replay);
+        return false;
+    }
+
+    if (sysfile_readLocal(game_ctx->replay.file, &header, sizeof(header), 1) != 1 ||
+        memcmp(header.magic, REPLAY_MAGIC, sizeof(header.magic)) != 0 ||
+        getU16(header.version) != REPLAY_VERSION ||
+        getU16(header.interval) != REPLAY_KEYFRAME_INTERVAL)
+    {
+        sys_error("(replay) \"%s\" is not a valid replay file", sysarg_args_replay);
+        return false;
+    }
+
+    game_ctx->replay.framesCount = getU32(header.frames);
+    game_ctx->replay.keyframesCount = getU32(header.keyframes);
+    game_ctx->replay.snapshotSize = getU16(header.snapshot);
+    game_ctx->replay.streamSize = getU32(header.size);
+    tableSize = game_ctx->replay.keyframesCount * sizeof(replay_keyframe_t);
+
+    /* snapshots are read on demand, by replay_seek */
+    if (sysfile_seekLocal(game_ctx->replay.file,
+                          sizeof(header) + game_ctx->replay.keyframesCount *
+                          game_ctx->replay.snapshotSize, SEEK_SET) != 0)
+    {
+        sys_error("(replay) \"%s\" is truncated", sysarg_args_replay);
+        return false;
+    }
+
+    game_ctx->replay.buffer = sysmem_push(tableSize + game_ctx->replay.streamSize);
+    if (!game_ctx->replay.buffer)
+    {
+        return false;
+    }
+    game_ctx->replay.keyframes = (replay_keyframe_t *)game_ctx->replay.buffer;
+    game_ctx->replay.stream = game_ctx->replay.buffer + tableSize;
+
+    if ((tableSize &&
+         sysfile_readLocal(game_ctx->replay.file, game_ctx->replay.keyframes,
+                           tableSize, 1) != 1) ||
+        (game_ctx->replay.streamSize &&
+         sysfile_readLocal(game_ctx->replay.file, game_ctx->replay.stream,
+                           game_ctx->replay.streamSize, 1) != 1))
+    {
+        sys_error("(replay) \"%s\" is truncated", sysarg_args_replay);
+        return false;
+    }
+
+    sysarg_args_period = getU16(header.period);
+    sysarg_args_map = getU16(header.map);
+    sysarg_args_submap = getU16(header.submap);
+
+    game_ctx->replay.mode = Replay_PLAY;
+    return true;
+}
+
+/*
+ * Append current inputs and seed to the stream.
+ */
+static void
+record(void)
+{
+    U32 inputs = getInputs();
+    U32 delta = e_them_rndseed - game_ctx->replay.seed;
+    bool isKeyframe = (game_ctx->replay.frame >= game_ctx->replay.nextKeyframe &&
+                       game_inPlay());
+
+    if (game_ctx->replay.runLength && !isKeyframe &&
+        inputs == game_ctx->replay.runInputs && delta == game_ctx->replay.runDelta)
+    {
+        game_ctx->replay.runLength++;
+    }
+    else
+    {
+        flushRun();
+
+        /* make sure next run and keyframe always fit */
+        if (game_ctx->replay.streamSize + 2 * REPLAY_RUN_MAXSIZE >
+            REPLAY_BUFFER_SIZE - (game_ctx->replay.keyframesCount + 1) * sizeof(replay_keyframe_t))
+        {
+            sys_printf("xrick/replay: buffer full, recording stopped at frame %u\n",
+                       game_ctx->replay.frame);
+            game_ctx->replay.stopped = true;
+            return;
+        }
+
+        if (isKeyframe)
+        {
+            replay_keyframe_t *keyframe =
+                &game_ctx->replay.keyframes[-(int)game_ctx->replay.keyframesCount];
+
+            if (!game_snapshotState((game_snapshot_t *)game_ctx->replay.snapshot) ||
+                sysfile_writeLocal(game_ctx->replay.file, game_ctx->replay.snapshot,
+                                   GAME_SNAPSHOT_STATE_SIZE, 1) != 1)
+            {
+                sys_error("(replay) can not write \"%s\", recording stopped at frame %u",
+                          sysarg_args_record, game_ctx->replay.frame);
+                game_ctx->replay.stopped = true;
+                return;
+            }
+            putU32(keyframe->frame, game_ctx->replay.frame);
+            putU32(keyframe->offset, game_ctx->replay.streamSize);
+            putU32(keyframe->seed, game_ctx->replay.seed);
+            putU32(keyframe->snapshot, sizeof(replay_header_t) +
+                   game_ctx->replay.keyframesCount * GAME_SNAPSHOT_STATE_SIZE);
+            game_ctx->replay.keyframesCount++;
+            game_ctx->replay.nextKeyframe = game_ctx->replay.frame + REPLAY_KEYFRAME_INTERVAL;
+        }
+
+        game_ctx->replay.runLength = 1;
+        game_ctx->replay.runInputs = inputs;
+        game_ctx->replay.runDelta = delta;
+    }
+
+    game_ctx->replay.seed = e_them_rndseed;
+    game_ctx->replay.frame++;
+}
+
+/*
+ * Override current inputs and seed with recorded ones.
+ */
+static void
+play(void)
+{
+    if (game_ctx->replay.frame == game_ctx->replay.framesCount ||
+        (!game_ctx->replay.runLength && !decodeRun()))
+    {
+        /* end of replay: give control back */
+        sys_printf("xrick/replay: end of replay at frame %u\n", game_ctx->replay.frame);
+        game_ctx->replay.stopped = true;
+        return;
+    }
+    game_ctx->replay.runLength--;
+    game_ctx->replay.seed += game_ctx->replay.runDelta;
+    game_ctx->replay.frame++;
+
+    if (e_them_rndseed != game_ctx->replay.seed && !game_ctx->replay.desync)
+    {
+        sys_printf("xrick/replay: desynchronized at frame %u\n", game_ctx->replay.frame - 1);
+        game_ctx->replay.desync = true;
+    }
+    e_them_rndseed = game_ctx->replay.seed;
+    setInputs(game_ctx->replay.runInputs);
+}
+
+/*
+ * Write current run to the stream.
+ */
+static void
+flushRun(void)
+{
+    if (!game_ctx->replay.runLength)
+    {
+        return;
+    }
+    putVarint(game_ctx->replay.runLength);
+    putVarint(game_ctx->replay.runInputs);
+    putVarint(game_ctx->replay.runDelta);
+    game_ctx->replay.framesCount += game_ctx->replay.runLength;
+    game_ctx->replay.runLength = 0;
+}
+
+/*
+ * Read next run from the stream.
+ */
+static bool
+decodeRun(void)
+{
+    if (game_ctx->replay.offset >= game_ctx->replay.streamSize)
+    {
+        return false;
+    }
+    game_ctx->replay.runLength = getVarint();
+    game_ctx->replay.runInputs = getVarint();
+    game_ctx->replay.runDelta = getVarint();
+    return (game_ctx->replay.runLength != 0);
+}
+
+/*
+ * Inputs are control_status in the low byte, and cheats in the high byte.
+ */
+static U32
+getInputs(void)
+{
+    U32 inputs = control_status & 0xff;
+#ifdef ENABLE_CHEATS
+    inputs |= (game_cheat1 ? 0x100 : 0) |
+              (game_cheat2 ? 0x200 : 0) |
+              (game_cheat3 ? 0x400 : 0);
+#endif
+    return inputs;
+}
+
+/*
+ * Live exit requests are kept, so that playback can be interrupted.
+ */
+static void
+setInputs(U32 inputs)
+{
+    control_status = (control_status & Control_EXIT) | (inputs & 0xff);
+#ifdef ENABLE_CHEATS
+    if (game_cheat1 != ((inputs & 0x100) != 0))
+    {
+        game_toggleCheat(Cheat_UNLIMITED_ALL);
+    }
+    if (game_cheat2 != ((inputs & 0x200) != 0))
+    {
+        game_toggleCheat(Cheat_NEVER_DIE);
+    }
+    if (game_cheat3 != ((inputs & 0x400) != 0))
+    {
+        game_toggleCheat(Cheat_EXPOSE);
+    }
+#endif
+}
+
+/*
+ * Variable length integers: 7 bits per byte, low bits first,
+ * high bit set on all bytes but the last one.
+ */
+static void
+putVarint(U32 value)
+{
+    while (value >= 0x80)
+    {
+        game_ctx->replay.stream[game_ctx->replay.streamSize++] = (U8)(value | 0x80);
+        value >>= 7;
+    }
+    game_ctx->replay.stream[game_ctx->replay.streamSize++] = (U8)value;
+}
+
+static U32
+getVarint(void)
+{
+    U32 value = 0;
+    U8 shift = 0;
+    U8 byte;
+
+    do
+    {
+        if (game_ctx->replay.offset >= game_ctx->replay.streamSize || shift > 28)
+        {
+            return 0;
+        }
+        byte = game_ctx->replay.stream[game_ctx->replay.offset++];
+        value |= (U32)(byte & 0x7f) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+    return value;
+}
+
+/*
+ *
+ */
+static void
+putU16(U8 *dst, U16 value)
+{
+    value = htole16(value);
+    memcpy(dst, &value, sizeof(value));
+}
+
+static void
+putU32(U8 *dst, U32 value)
+{
+    value = htole32(value);
+    memcpy(dst, &value, sizeof(value));
+}
+
+static U16
+getU16(const U8 *src)
+{
+    U16 value;
+    memcpy(&value, src, sizeof(value));
+    return letoh16(value);
+}
+
+static U32
+getU32(const U8 *src)
+{
+    U32 value;
+    memcpy(&value, src, sizeof(value));
+    return letoh32(value);
+}
+
+#endif /* ENABLE_REPLAY */
+
+/* eof */
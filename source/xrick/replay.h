@@ -0,0 +1,81 @@
+/*
+ * xrick/replay.h
+ *
+ * Copyright (C) 2008-2014 Pierluigi Vicinanza. All rights reserved.
+ *
+ * The use and distribution terms for this software are contained in the file
+ * named README, which can be found in the root of this distribution. By
+ * using this software in any fashion, you are agreeing to be bound by the
+ * terms of this license.
+ *
+ * You must not remove this notice, or any other, from this software.
+ */
+
+#ifndef _REPLAY_H
+#define _REPLAY_H
+
+#include "xrick/config.h"
+
+#ifdef ENABLE_REPLAY
+
+#include "xrick/system/basic_types.h"
+
+#define REPLAY_VERSION 2
+#define REPLAY_KEYFRAME_INTERVAL 250  /* frames between two keyframes */
+#define REPLAY_BUFFER_SIZE 0x8000     /* recording buffer, in bytes */
+
+/*
+ * A replay file is made of a header, followed by the keyframe snapshots,
+ * followed by the keyframes table, followed by the inputs stream.
+ *
+ * The stream is a sequence of runs. Each run covers a number of frames
+ * with the same inputs (control_status and cheats) and the same random
+ * seed increment, and is encoded as three variable length integers:
+ * frames count, inputs, seed increment. Runs never cross a keyframe.
+ *
+ * A keyframe is taken on the first frame of play at least
+ * REPLAY_KEYFRAME_INTERVAL frames after the previous one. It holds the
+ * game state before that frame (see game_snapshotState), the offset of
+ * the first run of that frame in the stream, and the random seed before
+ * that frame, so that playback can start from any keyframe.
+ *
+ * Like game snapshots, keyframe snapshots are only valid for the build
+ * that wrote them. Other builds play the inputs back, but can not seek.
+ *
+ * All data is assumed to be Little Endian
+ */
+typedef struct
+{
+    U8 magic[4];
+    U8 version[2];
+    U8 interval[2];   /* frames between two keyframes */
+    U8 period[2];     /* sysarg_args_period */
+    U8 map[2];        /* sysarg_args_map */
+    U8 submap[2];     /* sysarg_args_submap */
+    U8 snapshot[2];   /* keyframe snapshot size, in bytes */
+    U8 frames[4];     /* frames count */
+    U8 keyframes[4];  /* keyframes count */
+    U8 size[4];       /* stream size, in bytes */
+} replay_header_t;
+
+typedef struct
+{
+    U8 frame[4];
+    U8 offset[4];     /* offset in the stream, in bytes */
+    U8 seed[4];       /* e_them_rndseed before the frame */
+    U8 snapshot[4];   /* offset of the snapshot in the file, in bytes */
+} replay_keyframe_t;
+
+extern bool replay_open(void);
+extern void replay_close(void);
+extern void replay_update(void);
+extern bool replay_seek(U32);
+extern U32 replay_getFrame(void);
+extern bool replay_isPlaying(void);
+extern bool replay_isActive(void);
+
+#endif /* ENABLE_REPLAY */
+
+#endif /* ndef _REPLAY_H */
+
+/* eof */
@@ -0,0 +1,397 @@
+/*
+ * xrick/rewind.c
+ *
+ * Copyright (C) 2008-2014 Pierluigi Vicinanza. All rights reserved.
+ *
+ * The use and distribution terms for this software are contained in the file
+ * named README, which can be found in the root of this distribution. By
+ * using this software in any fashion, you are agreeing to be bound by the
+ * terms of this license.
+ *
+ * You must not remove this notice, or any other, from this software.
+ */
+
+#include "xrick/config.h"
+
+#ifdef ENABLE_REWIND
+
+#include "xrick/rewind.h"
+
+#include "xrick/game.h"
+#include "xrick/draw.h"
+#include "xrick/ents.h"
+#include "xrick/system/system.h"
+
+#include <string.h> /* memcpy, memset */
+
+/*
+ * prototypes
+ */
+static U32 encode(const U8 *, const U8 *, bool);
+static void decode(U32, U32, const U8 *, U8 *);
+static void evict(void);
+static U32 entryEnd(U32, rewind_entry_t *, U32 *);
+static void put(U32 *, U8);
+static U8 get(U32 *);
+
+/*
+ * Allocate the ring buffer, as requested by command line arguments.
+ */
+bool
+rewind_open(void)
+{
+    U32 size = sysarg_args_rewind * 1024;
+
+    memset(&game_ctx->rewind, 0, sizeof(game_ctx->rewind));
+    if (!size)
+    {
+        return true;
+    }
+    if (size < 2 * GAME_SNAPSHOT_STATE_SIZE)
+    {
+        sys_error("(rewind) buffer too small, %u KB at least",
+                  (U32)(2 * GAME_SNAPSHOT_STATE_SIZE + 1023) / 1024);
+        return false;
+    }
+
+    /* ring, then last keyframe and scratch states */
+    game_ctx->rewind.buffer = sysmem_push(size + 2 * GAME_SNAPSHOT_STATE_SIZE);
+    if (!game_ctx->rewind.buffer)
+    {
+        return false;
+    }
+    game_ctx->rewind.size = size;
+    game_ctx->rewind.key = game_ctx->rewind.buffer + size;
+    game_ctx->rewind.scratch = game_ctx->rewind.key + GAME_SNAPSHOT_STATE_SIZE;
+    return true;
+}
+
+/*
+ * Report memory cost and latency, and release the ring buffer.
+ */
+void
+rewind_close(void)
+{
+    if (!game_ctx->rewind.buffer)
+    {
+        return;
+    }
+
+    if (game_ctx->rewind.pushedFrames)
+    {
+        U32 perSecond = (U32)((double)game_ctx->rewind.pushedBytes * 1000 /
+                              ((double)game_ctx->rewind.pushedFrames * game_period));
+        sys_printf("xrick/rewind: %u bytes per second of play (%u frames, %u bytes),"
+                   " %u frames (%.1f s) in %u of %u bytes now\n",
+                   perSecond, game_ctx->rewind.pushedFrames, game_ctx->rewind.pushedBytes,
+                   game_ctx->rewind.entries,
+                   (double)game_ctx->rewind.entries * game_period / 1000,
+                   game_ctx->rewind.used, game_ctx->rewind.size);
+    }
+    if (game_ctx->rewind.steps)
+    {
+        sys_printf("xrick/rewind: %u steps back, latency %.1f us avg %u us max\n",
+                   game_ctx->rewind.steps,
+                   game_ctx->rewind.sumLatency / game_ctx->rewind.steps,
+                   game_ctx->rewind.maxLatency);
+    }
+
+    sysmem_pop(game_ctx->rewind.buffer);
+    game_ctx->rewind.buffer = NULL;
+}
+
+/*
+ * Store the state of the frame that just ended.
+ *
+ * Must be called in between frames.
+ */
+void
+rewind_push(void)
+{
+    U8 *state = game_ctx->rewind.scratch;
+    bool keyframe;
+    U32 size, pos;
+
+    if (!game_ctx->rewind.buffer ||
+        !game_snapshotState((game_snapshot_t *)state))
+    {
+        return;
+    }
+
+    keyframe = (game_ctx->rewind.entries == 0 ||
+                game_ctx->rewind.sinceKey + 1 >= REWIND_KEYFRAME_INTERVAL);
+    size = encode(state, keyframe ? NULL : game_ctx->rewind.key, false);
+
+    /* make room, a keyframe can not be dropped while the entry depends on it */
+    while (game_ctx->rewind.size - game_ctx->rewind.used < size + REWIND_ENTRY_OVERHEAD)
+    {
+        evict();
+        if (!game_ctx->rewind.entries && !keyframe)
+        {
+            keyframe = true;
+            size = encode(state, NULL, false);
+        }
+    }
+
+    pos = game_ctx->rewind.head;
+    put(&pos, keyframe ? Rewind_KEYFRAME : Rewind_DELTA);
+    put(&pos, size & 0xff);
+    put(&pos, size >> 8);
+    game_ctx->rewind.head = pos;
+    encode(state, keyframe ? NULL : game_ctx->rewind.key, true);
+    pos = game_ctx->rewind.head;
+    put(&pos, size & 0xff);
+    put(&pos, size >> 8);
+    put(&pos, keyframe ? Rewind_KEYFRAME : Rewind_DELTA);
+    game_ctx->rewind.head = pos;
+
+    game_ctx->rewind.used += size + REWIND_ENTRY_OVERHEAD;
+    game_ctx->rewind.entries++;
+    if (keyframe)
+    {
+        memcpy(game_ctx->rewind.key, state, GAME_SNAPSHOT_STATE_SIZE);
+        game_ctx->rewind.sinceKey = 0;
+    }
+    else
+    {
+        game_ctx->rewind.sinceKey++;
+    }
+    game_ctx->rewind.pushedFrames++;
+    game_ctx->rewind.pushedBytes += size + REWIND_ENTRY_OVERHEAD;
+}
+
+/*
+ * Go back one frame: drop the newest entry, which is the current state,
+ * restore the one before, and redraw the screen. Once the oldest entry
+ * is reached, the game stands still.
+ *
+ * Must be called in between frames, while playing. Return false when
+ * there is no rewinding, and the frame should run as usual.
+ */
+bool
+rewind_step(void)
+{
+    rewind_entry_t type;
+    U32 start, end, size, payload;
+
+    if (!game_ctx->rewind.buffer)
+    {
+        return false;
+    }
+    if (game_ctx->rewind.entries < 2)
+    {
+        game_rects = NULL;  /* nothing changed */
+        return true;
+    }
+    start = sys_gettimeUs();
+
+    /* drop newest entry */
+    end = game_ctx->rewind.head;
+    game_ctx->rewind.head = entryEnd(end, &type, &size);
+    game_ctx->rewind.used -= size + REWIND_ENTRY_OVERHEAD;
+    game_ctx->rewind.entries--;
+
+    if (type == Rewind_KEYFRAME)
+    {
+        /* decode the keyframe the remaining entries depend on */
+        U32 count = 0;
+        end = game_ctx->rewind.head;
+        while (1)
+        {
+            U32 prev = entryEnd(end, &type, &size);
+            if (type == Rewind_KEYFRAME)
+            {
+                payload = (prev + 3) % game_ctx->rewind.size;
+                decode(payload, size, NULL, game_ctx->rewind.key);
+                break;
+            }
+            count++;
+            end = prev;
+        }
+        game_ctx->rewind.sinceKey = count;
+    }
+    else
+    {
+        game_ctx->rewind.sinceKey--;
+    }
+
+    /* restore newest entry */
+    if (game_ctx->rewind.sinceKey == 0)
+    {
+        memcpy(game_ctx->rewind.scratch, game_ctx->rewind.key, GAME_SNAPSHOT_STATE_SIZE);
+    }
+    else
+    {
+        end = entryEnd(game_ctx->rewind.head, &type, &size);
+        payload = (end + 3) % game_ctx->rewind.size;
+        decode(payload, size, game_ctx->rewind.key, game_ctx->rewind.scratch);
+    }
+    if (!game_restoreState((const game_snapshot_t *)game_ctx->rewind.scratch))
+    {
+        return false;
+    }
+
+    /* redraw */
+    ent_clprev();
+    draw_map();
+    draw_clearStatus();
+    ent_draw();
+    draw_drawStatus();
+    game_rects = &draw_SCREENRECT;
+
+    end = sys_gettimeUs() - start;
+    game_ctx->rewind.steps++;
+    game_ctx->rewind.sumLatency += end;
+    if (end > game_ctx->rewind.maxLatency)
+    {
+        game_ctx->rewind.maxLatency = end;
+    }
+    return true;
+}
+
+/*
+ * Run length encode state XOR reference (or state alone when there is no
+ * reference), and return encoded size. When 'write' is true, the encoded
+ * bytes go to the ring, at head.
+ */
+static U32
+encode(const U8 *state, const U8 *ref, bool write)
+{
+    U32 pos = game_ctx->rewind.head;
+    U32 size = 0;
+    U32 i = 0;
+    U32 n, zeroes, count;
+
+    while (i < GAME_SNAPSHOT_STATE_SIZE)
+    {
+        zeroes = 0;
+        while (i < GAME_SNAPSHOT_STATE_SIZE && zeroes < 0xff &&
+               (state[i] ^ (ref ? ref[i] : 0)) == 0)
+        {
+            zeroes++;
+            i++;
+        }
+        count = 0;
+        while (i + count < GAME_SNAPSHOT_STATE_SIZE && count < 0xff &&
+               (state[i + count] ^ (ref ? ref[i + count] : 0)) != 0)
+        {
+            count++;
+        }
+        if (write)
+        {
+            put(&pos, zeroes);
+            put(&pos, count);
+            for (n = 0; n < count; n++)
+            {
+                put(&pos, state[i + n] ^ (ref ? ref[i + n] : 0));
+            }
+        }
+        i += count;
+        size += 2 + count;
+    }
+
+    if (write)
+    {
+        game_ctx->rewind.head = pos;
+    }
+    return size;
+}
+
+/*
+ * Decode 'size' bytes of the ring, from 'pos', into state.
+ */
+static void
+decode(U32 pos, U32 size, const U8 *ref, U8 *state)
+{
+    U32 i = 0;
+    U32 zeroes, count;
+
+    if (ref)
+    {
+        memcpy(state, ref, GAME_SNAPSHOT_STATE_SIZE);
+    }
+    else
+    {
+        memset(state, 0, GAME_SNAPSHOT_STATE_SIZE);
+    }
+
+    while (size)
+    {
+        zeroes = get(&pos);
+        count = get(&pos);
+        size -= 2 + count;
+        i += zeroes;
+        while (count--)
+        {
+            state[i++] ^= get(&pos);
+        }
+    }
+}
+
+/*
+ * Drop the oldest entry, then the entries depending on it, if any.
+ */
+static void
+evict(void)
+{
+    U32 pos, size;
+    rewind_entry_t type;
+
+    do
+    {
+        pos = game_ctx->rewind.tail;
+        get(&pos);
+        size = get(&pos);
+        size |= get(&pos) << 8;
+        game_ctx->rewind.tail = (pos + size + 3) % game_ctx->rewind.size;
+        game_ctx->rewind.used -= size + REWIND_ENTRY_OVERHEAD;
+        game_ctx->rewind.entries--;
+
+        pos = game_ctx->rewind.tail;
+        type = get(&pos);
+    }
+    while (game_ctx->rewind.entries && type != Rewind_KEYFRAME);
+}
+
+/*
+ * Read the trailer of the entry ending at 'end', return where it starts.
+ */
+static U32
+entryEnd(U32 end, rewind_entry_t *type, U32 *size)
+{
+    U32 ringSize = game_ctx->rewind.size;
+    U32 pos = (end + ringSize - 3) % ringSize;
+
+    *size = get(&pos);
+    *size |= get(&pos) << 8;
+    *type = get(&pos);
+    return (end + 2 * ringSize - *size - REWIND_ENTRY_OVERHEAD) % ringSize;
+}
+
+/*
+ * Ring buffer accessors.
+ */
+static void
+put(U32 *pos, U8 value)
+{
+    game_ctx->rewind.buffer[*pos] = value;
+    if (++*pos == game_ctx->rewind.size)
+    {
+        *pos = 0;
+    }
+}
+
+static U8
+get(U32 *pos)
+{
+    U8 value = game_ctx->rewind.buffer[*pos];
+    if (++*pos == game_ctx->rewind.size)
+    {
+        *pos = 0;
+    }
+    return value;
+}
+
+#endif /* ENABLE_REWIND */
+
+/* eof */
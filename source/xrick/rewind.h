@@ -0,0 +1,58 @@
+/*
+ * xrick/rewind.h
+ *
+ * Copyright (C) 2008-2014 Pierluigi Vicinanza. All rights reserved.
+ *
+ * The use and distribution terms for this software are contained in the file
+ * named README, which can be found in the root of this distribution. By
+ * using this software in any fashion, you are agreeing to be bound by the
+ * terms of this license.
+ *
+ * You must not remove this notice, or any other, from this software.
+ */
+
+#ifndef _REWIND_H
+#define _REWIND_H
+
+#include "xrick/config.h"
+
+#ifdef ENABLE_REWIND
+
+#include "xrick/system/basic_types.h"
+
+#define REWIND_KEYFRAME_INTERVAL 25  /* entries between two keyframes */
+
+/*
+ * The last frames of play are kept in a ring buffer, one entry per frame,
+ * each holding the game state as of the end of that frame (see
+ * game_snapshotState, the frame buffer is not part of it).
+ *
+ * Every REWIND_KEYFRAME_INTERVAL entries, a keyframe holds the whole
+ * state. Other entries hold the state XORed with that of their keyframe:
+ * since most of the state does not change from one frame to the next,
+ * this is mostly zeroes. Both are run length encoded as a sequence of
+ * (zeroes count, bytes count, bytes) triplets, counts being one byte.
+ *
+ * Entries are framed by a header (type, payload size) and a trailer
+ * (payload size, type), so that the ring can be walked both ways. When
+ * the ring is full, oldest entries are dropped: a keyframe along with the
+ * entries that depend on it.
+ */
+typedef enum
+{
+    Rewind_KEYFRAME = 1,
+    Rewind_DELTA = 2
+} rewind_entry_t;
+
+#define REWIND_ENTRY_OVERHEAD 6  /* header and trailer, in bytes */
+
+extern bool rewind_open(void);
+extern void rewind_close(void);
+extern void rewind_push(void);
+extern bool rewind_step(void);
+
+#endif /* ENABLE_REWIND */
+
+#endif /* ndef _REWIND_H */
+
+/* eof */
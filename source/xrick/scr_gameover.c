@@ -28,26 +28,21 @@
 U8
 screen_gameover(void)
 {
-    static U8 seq = 0;
-    static U8 period = 0;
-#ifdef GFXST
-    static U32 tm = 0;
-#endif
-    if (seq == 0) {
+    if (game_ctx->screens.gameover.seq == 0) {
         draw_tilesBank = 0;
-        seq = 1;
-        period = game_period; /* save period, */
+        game_ctx->screens.gameover.seq = 1;
+        game_ctx->screens.gameover.period = game_period; /* save period, */
         game_period = 50;     /* and use our own */
 #ifdef ENABLE_SOUND
         game_setmusic(soundGameover, 1);
 #endif
     }
 
-    switch (seq) {
+    switch (game_ctx->screens.gameover.seq) {
     case 1:  /* display banner */
 #ifdef GFXST
         sysvid_clear();
-        tm = sys_gettime();
+        game_ctx->screens.gameover.tm = game_time;
 #endif
         draw_tllst = screen_gameovertxt;
         draw_setfb(120, 80);
@@ -58,31 +53,31 @@ screen_gameover(void)
         draw_drawStatus();
 
         game_rects = &draw_SCREENRECT;
-        seq = 2;
+        game_ctx->screens.gameover.seq = 2;
         break;
 
     case 2:  /* wait for key pressed */
         if (control_test(Control_FIRE))
-            seq = 3;
+            game_ctx->screens.gameover.seq = 3;
 #ifdef GFXST
-        else if (sys_gettime() - tm > SCREEN_TIMEOUT)
-            seq = 4;
+        else if (game_time - game_ctx->screens.gameover.tm > SCREEN_TIMEOUT)
+            game_ctx->screens.gameover.seq = 4;
 #endif
         break;
 
     case 3:  /* wait for key released */
         if (!(control_test(Control_FIRE)))
-            seq = 4;
+            game_ctx->screens.gameover.seq = 4;
         break;
     }
 
     if (control_test(Control_EXIT))  /* check for exit request */
         return SCREEN_EXIT;
 
-    if (seq == 4) {  /* we're done */
+    if (game_ctx->screens.gameover.seq == 4) {  /* we're done */
         sysvid_clear();
-        seq = 0;
-        game_period = period;
+        game_ctx->screens.gameover.seq = 0;
+        game_period = game_ctx->screens.gameover.period;
         return SCREEN_DONE;
     }
 
@@ -21,13 +21,6 @@
 #include "xrick/data/pics.h"
 #include "xrick/system/system.h"
 
-/*
- * local vars
- */
-static U8 seq = 0;
-static U8 x, y, p;
-static U8 player_name[HISCORE_NAME_SIZE];
-
 #define TILE_POINTER '\072'
 #define TILE_CURSOR '\073'
 #define TOPLEFT_X 116
@@ -53,10 +46,9 @@ static void name_draw(void);
 U8
 screen_getname(void)
 {
-    static U32 tm = 0;
-    U8 i, j;
+    U8 i, j, k;
 
-    if (seq == 0)
+    if (game_ctx->screens.getname.seq == 0)
     {
         /* figure out if this is a high score */
         if (game_score < screen_highScores[screen_nbr_hiscores - 1].score)
@@ -69,14 +61,14 @@ screen_getname(void)
 #endif
         for (i = 0; i < HISCORE_NAME_SIZE; i++)
         {
-            player_name[i] = '@';
+            game_ctx->screens.getname.name[i] = '@';
         }
-        x = 5, y = 4, p = 0;
+        game_ctx->screens.getname.x = 5, game_ctx->screens.getname.y = 4, game_ctx->screens.getname.p = 0;
         game_rects = &draw_SCREENRECT;
-        seq = 1;
+        game_ctx->screens.getname.seq = 1;
     }
 
-    switch (seq)
+    switch (game_ctx->screens.getname.seq)
     {
         case 1:  /* prepare screen */
         {
@@ -114,48 +106,48 @@ screen_getname(void)
 #endif
             name_draw();
             pointer_show(true);
-            seq = 2;
+            game_ctx->screens.getname.seq = 2;
             break;
         }
         case 2:  /* wait for key pressed */
         {
             if (control_test(Control_FIRE))
-                seq = 3;
+                game_ctx->screens.getname.seq = 3;
             if (control_test(Control_UP)) {
-                if (y > 0) {
+                if (game_ctx->screens.getname.y > 0) {
                     pointer_show(false);
-                    y--;
+                    game_ctx->screens.getname.y--;
                     pointer_show(true);
-                    tm = sys_gettime();
+                    game_ctx->screens.getname.tm = game_time;
                 }
-                seq = 4;
+                game_ctx->screens.getname.seq = 4;
             }
             if (control_test(Control_DOWN)) {
-                if (y < 4) {
+                if (game_ctx->screens.getname.y < 4) {
                     pointer_show(false);
-                    y++;
+                    game_ctx->screens.getname.y++;
                     pointer_show(true);
-                    tm = sys_gettime();
+                    game_ctx->screens.getname.tm = game_time;
                 }
-                seq = 5;
+                game_ctx->screens.getname.seq = 5;
             }
             if (control_test(Control_LEFT)) {
-                if (x > 0) {
+                if (game_ctx->screens.getname.x > 0) {
                     pointer_show(false);
-                    x--;
+                    game_ctx->screens.getname.x--;
                     pointer_show(true);
-                    tm = sys_gettime();
+                    game_ctx->screens.getname.tm = game_time;
                 }
-                seq = 6;
+                game_ctx->screens.getname.seq = 6;
             }
             if (control_test(Control_RIGHT)) {
-                if (x < 5) {
+                if (game_ctx->screens.getname.x < 5) {
                     pointer_show(false);
-                    x++;
+                    game_ctx->screens.getname.x++;
                     pointer_show(true);
-                    tm = sys_gettime();
+                    game_ctx->screens.getname.tm = game_time;
                 }
-                seq = 7;
+                game_ctx->screens.getname.seq = 7;
             }
             break;
         }
@@ -163,7 +155,7 @@ screen_getname(void)
         {
             if (!(control_test(Control_FIRE)))
             {
-                if (x == 5 && y == 4)
+                if (game_ctx->screens.getname.x == 5 && game_ctx->screens.getname.y == 4)
                 {  /* end */
                     i = 0;
                     while (game_score < screen_highScores[i].score) i++;
@@ -171,24 +163,24 @@ screen_getname(void)
                     while (j > i)
                     {
                         screen_highScores[j].score = screen_highScores[j - 1].score;
-                        for (x = 0; x < HISCORE_NAME_SIZE; x++)
+                        for (k = 0; k < HISCORE_NAME_SIZE; k++)
                         {
-                            screen_highScores[j].name[x] = screen_highScores[j - 1].name[x];
+                            screen_highScores[j].name[k] = screen_highScores[j - 1].name[k];
                         }
                         j--;
                     }
                     screen_highScores[i].score = game_score;
-                    for (x = 0; x < HISCORE_NAME_SIZE; x++)
+                    for (k = 0; k < HISCORE_NAME_SIZE; k++)
                     {
-                        screen_highScores[i].name[x] = player_name[x];
+                        screen_highScores[i].name[k] = game_ctx->screens.getname.name[k];
                     }
-                    seq = 99;
+                    game_ctx->screens.getname.seq = 99;
                 }
                 else
                 {
                     name_update();
                     name_draw();
-                    seq = 2;
+                    game_ctx->screens.getname.seq = 2;
                 }
             }
             break;
@@ -196,29 +188,29 @@ screen_getname(void)
         case 4:  /* wait for UP released */
         {
             if (!(control_test(Control_UP)) ||
-                sys_gettime() - tm > AUTOREPEAT_TMOUT)
-                seq = 2;
+                game_time - game_ctx->screens.getname.tm > AUTOREPEAT_TMOUT)
+                game_ctx->screens.getname.seq = 2;
             break;
         }
         case 5:  /* wait for DOWN released */
         {
             if (!(control_test(Control_DOWN)) ||
-                sys_gettime() - tm > AUTOREPEAT_TMOUT)
-                seq = 2;
+                game_time - game_ctx->screens.getname.tm > AUTOREPEAT_TMOUT)
+                game_ctx->screens.getname.seq = 2;
             break;
         }
         case 6:  /* wait for LEFT released */
         {
             if (!(control_test(Control_LEFT)) ||
-                sys_gettime() - tm > AUTOREPEAT_TMOUT)
-                seq = 2;
+                game_time - game_ctx->screens.getname.tm > AUTOREPEAT_TMOUT)
+                game_ctx->screens.getname.seq = 2;
             break;
         }
         case 7:  /* wait for RIGHT released */
         {
             if (!(control_test(Control_RIGHT)) ||
-                sys_gettime() - tm > AUTOREPEAT_TMOUT)
-                seq = 2;
+                game_time - game_ctx->screens.getname.tm > AUTOREPEAT_TMOUT)
+                game_ctx->screens.getname.seq = 2;
             break;
         }
     }
@@ -226,9 +218,9 @@ screen_getname(void)
     if (control_test(Control_EXIT))  /* check for exit request */
         return SCREEN_EXIT;
 
-    if (seq == 99) {  /* seq 99, we're done */
+    if (game_ctx->screens.getname.seq == 99) {  /* seq 99, we're done */
         sysvid_clear();
-        seq = 0;
+        game_ctx->screens.getname.seq = 0;
         return SCREEN_DONE;
     }
     else
@@ -239,7 +231,7 @@ screen_getname(void)
 static void
 pointer_show(bool show)
 {
-  draw_setfb(TOPLEFT_X + x * 8 * 2, TOPLEFT_Y + y * 8 * 2 + 8);
+  draw_setfb(TOPLEFT_X + game_ctx->screens.getname.x * 8 * 2, TOPLEFT_Y + game_ctx->screens.getname.y * 8 * 2 + 8);
 #ifdef GFXPC
   draw_filter = 0xaaaa; /* red */
 #endif
@@ -251,15 +243,15 @@ name_update(void)
 {
   U8 i;
 
-  i = x + y * 6;
-  if (i < 26 && p < 10)
-    player_name[p++] = 'A' + i;
-  if (i == 26 && p < 10)
-    player_name[p++] = '.';
-  if (i == 27 && p < 10)
-    player_name[p++] = '@';
-  if (i == 28 && p > 0) {
-    p--;
+  i = game_ctx->screens.getname.x + game_ctx->screens.getname.y * 6;
+  if (i < 26 && game_ctx->screens.getname.p < 10)
+    game_ctx->screens.getname.name[game_ctx->screens.getname.p++] = 'A' + i;
+  if (i == 26 && game_ctx->screens.getname.p < 10)
+    game_ctx->screens.getname.name[game_ctx->screens.getname.p++] = '.';
+  if (i == 27 && game_ctx->screens.getname.p < 10)
+    game_ctx->screens.getname.name[game_ctx->screens.getname.p++] = '@';
+  if (i == 28 && game_ctx->screens.getname.p > 0) {
+    game_ctx->screens.getname.p--;
   }
 }
 
@@ -272,16 +264,16 @@ name_draw(void)
 #ifdef GFXPC
   draw_filter = 0xaaaa; /* red */
 #endif
-  for (i = 0; i < p; i++)
-    draw_tile(player_name[i]);
-  for (i = p; i < 10; i++)
+  for (i = 0; i < game_ctx->screens.getname.p; i++)
+    draw_tile(game_ctx->screens.getname.name[i]);
+  for (i = game_ctx->screens.getname.p; i < 10; i++)
     draw_tile(TILE_CURSOR);
 
 #ifdef GFXST
   draw_setfb(NAMEPOS_X, NAMEPOS_Y + 8);
   for (i = 0; i < 10; i++)
     draw_tile('@');
-  draw_setfb(NAMEPOS_X + 8 * (p < 9 ? p : 9), NAMEPOS_Y + 8);
+  draw_setfb(NAMEPOS_X + 8 * (game_ctx->screens.getname.p < 9 ? game_ctx->screens.getname.p : 9), NAMEPOS_Y + 8);
   draw_tile(TILE_POINTER);
 #endif
 }
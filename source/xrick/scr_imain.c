@@ -31,19 +31,13 @@
 U8
 screen_introMain(void)
 {
-    static U8 seq = 0;
-    static U8 seen = 0;
-    static bool first = true;
-    static U8 period = 0;
-    static U32 tm = 0;
-
-    if (seq == 0) {
+    if (game_ctx->screens.imain.seq == 0) {
         draw_tilesBank = 0;
-        if (first)
-            seq = 1;
+        if (game_ctx->screens.imain.first)
+            game_ctx->screens.imain.seq = 1;
         else
-            seq = 4;
-        period = game_period;
+            game_ctx->screens.imain.seq = 4;
+        game_ctx->screens.imain.period = game_period;
         game_period = 50;
         game_rects = &draw_SCREENRECT;
 #ifdef ENABLE_SOUND
@@ -51,12 +45,12 @@ screen_introMain(void)
 #endif
     }
 
-    switch (seq)
+    switch (game_ctx->screens.imain.seq)
     {
         case 1:  /* display Rick Dangerous title and Core Design copyright */
         {
             sysvid_clear();
-            tm = sys_gettime();
+            game_ctx->screens.imain.tm = game_time;
 #ifdef GFXPC
             /* Rick Dangerous title */
             draw_tllst = (U8 *)screen_imainrdt;
@@ -73,26 +67,26 @@ screen_introMain(void)
 #ifdef GFXST
             draw_pic(pic_splash);
 #endif
-            seq = 2;
+            game_ctx->screens.imain.seq = 2;
             break;
         }
         case 2:  /* wait for key pressed or timeout */
         {
             if (control_test(Control_FIRE))
-                seq = 3;
-            else if (sys_gettime() - tm > SCREEN_TIMEOUT) {
-                seen++;
-                seq = 4;
+                game_ctx->screens.imain.seq = 3;
+            else if (game_time - game_ctx->screens.imain.tm > SCREEN_TIMEOUT) {
+                game_ctx->screens.imain.seen++;
+                game_ctx->screens.imain.seq = 4;
             }
             break;
         }
         case 3:  /* wait for key released */
         {
             if (!(control_test(Control_FIRE))) {
-                if (seen++ == 0)
-                    seq = 4;
+                if (game_ctx->screens.imain.seen++ == 0)
+                    game_ctx->screens.imain.seq = 4;
                 else
-                    seq = 7;
+                    game_ctx->screens.imain.seq = 7;
             }
             break;
         }
@@ -102,7 +96,7 @@ screen_introMain(void)
             size_t i;
 
             sysvid_clear();
-            tm = sys_gettime();
+            game_ctx->screens.imain.tm = game_time;
             /* hall of fame title */
 #ifdef GFXPC
             draw_tllst = (U8 *)screen_imainhoft;
@@ -127,26 +121,26 @@ screen_introMain(void)
                 draw_tllst = s;
                 draw_tilesList();
             }
-            seq = 5;
+            game_ctx->screens.imain.seq = 5;
             break;
         }
         case 5:  /* wait for key pressed or timeout */
         {
             if (control_test(Control_FIRE))
-                seq = 6;
-            else if (sys_gettime() - tm > SCREEN_TIMEOUT) {
-                seen++;
-                seq = 1;
+                game_ctx->screens.imain.seq = 6;
+            else if (game_time - game_ctx->screens.imain.tm > SCREEN_TIMEOUT) {
+                game_ctx->screens.imain.seen++;
+                game_ctx->screens.imain.seq = 1;
             }
             break;
         }
         case 6:  /* wait for key released */
         {
             if (!(control_test(Control_FIRE))) {
-                if (seen++ == 0)
-                    seq = 1;
+                if (game_ctx->screens.imain.seen++ == 0)
+                    game_ctx->screens.imain.seq = 1;
                 else
-                    seq = 7;
+                    game_ctx->screens.imain.seq = 7;
             }
             break;
         }
@@ -155,12 +149,12 @@ screen_introMain(void)
     if (control_test(Control_EXIT))  /* check for exit request */
         return SCREEN_EXIT;
 
-    if (seq == 7) {  /* we're done */
+    if (game_ctx->screens.imain.seq == 7) {  /* we're done */
         sysvid_clear();
-        seq = 0;
-        seen = 0;
-        first = false;
-        game_period = period;
+        game_ctx->screens.imain.seq = 0;
+        game_ctx->screens.imain.seen = 0;
+        game_ctx->screens.imain.first = false;
+        game_period = game_ctx->screens.imain.period;
         return SCREEN_DONE;
     }
     else
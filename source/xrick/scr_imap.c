@@ -24,16 +24,6 @@
 /*
  * local vars
  */
-static U16 step;              /* current step */
-static U16 count;             /* number of loops for current step */
-static U16 run;               /* 1 = run, 0 = no more step */
-static U8 flipflop;           /* flipflop for top, bottom, left, right */
-static U8 spnum;              /* sprite number */
-static U16 spx, spdx;         /* sprite x position and delta */
-static U16 spy, spdy;         /* sprite y position and delta */
-static U16 spbase, spoffs;    /* base, offset for sprite numbers table */
-static U8 seq = 0;            /* anim sequence */
-
 static rect_t anim_rect = { 128, 16 + 16, 64, 64, NULL }; /* anim rectangle */
 
 /*
@@ -57,7 +47,7 @@ static void init(void);
 U8
 screen_introMap(void)
 {
-  switch (seq) {
+  switch (game_ctx->screens.imap.seq) {
   case 0:
     sysvid_clear();
 
@@ -98,42 +88,42 @@ screen_introMap(void)
     game_setmusic(map_maps[game_map].tune, 1);
 #endif
 
-    seq = 1;
+    game_ctx->screens.imap.seq = 1;
     break;
   case 1:  /* top and bottom borders */
     drawtb();
     game_rects = &anim_rect;
-    seq = 2;
+    game_ctx->screens.imap.seq = 2;
     break;
   case 2:  /* background and sprite */
     anim();
     drawcenter();
     drawsprite();
     game_rects = &anim_rect;
-    seq = 3;
+    game_ctx->screens.imap.seq = 3;
     break;
   case 3:  /* all borders */
     drawtb();
     drawlr();
     game_rects = &anim_rect;
-    seq = 1;
+    game_ctx->screens.imap.seq = 1;
     break;
   case 4:  /* wait for key release */
     if (!(control_test(Control_FIRE)))
-      seq = 5;
+      game_ctx->screens.imap.seq = 5;
     break;
   }
 
   if (control_test(Control_FIRE)) {  /* end as soon as key pressed */
-    seq = 4;
+    game_ctx->screens.imap.seq = 4;
   }
 
   if (control_test(Control_EXIT))  /* check for exit request */
     return SCREEN_EXIT;
 
-  if (seq == 5) {  /* end as soon as key pressed */
+  if (game_ctx->screens.imap.seq == 5) {  /* end as soon as key pressed */
     sysvid_clear();
-    seq = 0;
+    game_ctx->screens.imap.seq = 0;
     return SCREEN_DONE;
   }
   else
@@ -150,8 +140,8 @@ drawtb(void)
 {
   U8 i;
 
-  flipflop++;
-  if (flipflop & 0x01) {
+  game_ctx->screens.imap.flipflop++;
+  if (game_ctx->screens.imap.flipflop & 0x01) {
     draw_setfb(136, 16 + 16);
     for (i = 0; i < 6; i++)
       draw_tile(0x40);
@@ -179,7 +169,7 @@ drawlr(void)
 {
   U8 i;
 
-  if (flipflop & 0x02) {
+  if (game_ctx->screens.imap.flipflop & 0x02) {
     for (i = 0; i < 8; i++) {
       draw_setfb(128, 16 + i * 8 + 16);
       draw_tile(0x04);
@@ -205,7 +195,7 @@ drawlr(void)
 static void
 drawsprite(void)
 {
-  draw_sprite(spnum, 136 + ((spx << 1) & 0x1C), 24 + (spy << 1) + 16);
+  draw_sprite(game_ctx->screens.imap.spnum, 136 + ((game_ctx->screens.imap.spx << 1) & 0x1C), 24 + (game_ctx->screens.imap.spy << 1) + 16);
 }
 
 
@@ -235,16 +225,16 @@ drawcenter(void)
 static void
 nextstep(void)
 {
-  if (screen_imapsteps[step].count) {
-    count = screen_imapsteps[step].count;
-    spdx = screen_imapsteps[step].dx;
-    spdy = screen_imapsteps[step].dy;
-    spbase = screen_imapsteps[step].base;
-    spoffs = 0;
-    step++;
+  if (screen_imapsteps[game_ctx->screens.imap.step].count) {
+    game_ctx->screens.imap.count = screen_imapsteps[game_ctx->screens.imap.step].count;
+    game_ctx->screens.imap.spdx = screen_imapsteps[game_ctx->screens.imap.step].dx;
+    game_ctx->screens.imap.spdy = screen_imapsteps[game_ctx->screens.imap.step].dy;
+    game_ctx->screens.imap.spbase = screen_imapsteps[game_ctx->screens.imap.step].base;
+    game_ctx->screens.imap.spoffs = 0;
+    game_ctx->screens.imap.step++;
   }
   else {
-    run = 0;
+    game_ctx->screens.imap.run = 0;
   }
 }
 
@@ -258,18 +248,18 @@ anim(void)
 {
   U8 i;
 
-  if (run) {
-    i = screen_imapsl[spbase + spoffs];
+  if (game_ctx->screens.imap.run) {
+    i = screen_imapsl[game_ctx->screens.imap.spbase + game_ctx->screens.imap.spoffs];
     if (i == 0) {
-      spoffs = 0;
-      i = screen_imapsl[spbase];
+      game_ctx->screens.imap.spoffs = 0;
+      i = screen_imapsl[game_ctx->screens.imap.spbase];
     }
-    spnum = i;
-    spoffs++;
-    spx += spdx;
-    spy += spdy;
-    count--;
-    if (count == 0)
+    game_ctx->screens.imap.spnum = i;
+    game_ctx->screens.imap.spoffs++;
+    game_ctx->screens.imap.spx += game_ctx->screens.imap.spdx;
+    game_ctx->screens.imap.spy += game_ctx->screens.imap.spdy;
+    game_ctx->screens.imap.count--;
+    if (game_ctx->screens.imap.count == 0)
       nextstep();
   }
 }
@@ -282,12 +272,12 @@ anim(void)
 static void
 init(void)
 {
-  run = 0; run--;
-  step = screen_imapsofs[game_map];
-  spx = screen_imapsteps[step].dx;
-  spy = screen_imapsteps[step].dy;
-  step++;
-  spnum = 0; /* NOTE spnum in [8728] is never initialized ? */
+  game_ctx->screens.imap.run = 0; game_ctx->screens.imap.run--;
+  game_ctx->screens.imap.step = screen_imapsofs[game_map];
+  game_ctx->screens.imap.spx = screen_imapsteps[game_ctx->screens.imap.step].dx;
+  game_ctx->screens.imap.spy = screen_imapsteps[game_ctx->screens.imap.step].dy;
+  game_ctx->screens.imap.step++;
+  game_ctx->screens.imap.spnum = 0; /* NOTE spnum in [8728] is never initialized ? */
 }
 
 /* eof */
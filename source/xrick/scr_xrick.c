@@ -37,7 +37,6 @@ size_t screen_nbr_imaptext = 0;
 U8 **screen_imaptext = NULL;
 
 size_t screen_nbr_hiscores = 0;
-hiscore_t *screen_highScores = NULL;
 
 #ifdef GFXPC
 U8 *screen_imainhoft = NULL;
@@ -57,41 +56,38 @@ U8 *screen_pausedtxt = NULL;
 U8
 screen_xrick(void)
 {
-    static U8 seq = 0;
-    static U8 wait = 0;
-
-    if (seq == 0) {
+    if (game_ctx->screens.xrick.seq == 0) {
         sysvid_clear();
         draw_img(img_splash);
         game_rects = &draw_SCREENRECT;
-        seq = 1;
+        game_ctx->screens.xrick.seq = 1;
     }
 
-    switch (seq) {
+    switch (game_ctx->screens.xrick.seq) {
     case 1:  /* wait */
-        if (wait++ > 0x2) {
+        if (game_ctx->screens.xrick.wait++ > 0x2) {
 #ifdef ENABLE_SOUND
             game_setmusic(soundBullet, 1);
 #endif
-            seq = 2;
-            wait = 0;
+            game_ctx->screens.xrick.seq = 2;
+            game_ctx->screens.xrick.wait = 0;
         }
         break;
 
     case 2:  /* wait */
-        if (wait++ > 0x20) {
-            seq = 99;
-            wait = 0;
+        if (game_ctx->screens.xrick.wait++ > 0x20) {
+            game_ctx->screens.xrick.seq = 99;
+            game_ctx->screens.xrick.wait = 0;
         }
     }
 
     if (control_test(Control_EXIT))  /* check for exit request */
         return SCREEN_EXIT;
 
-    if (seq == 99) {  /* we're done */
+    if (game_ctx->screens.xrick.seq == 99) {  /* we're done */
         sysvid_clear();
         sysvid_setGamePalette();
-        seq = 0;
+        game_ctx->screens.xrick.seq = 0;
         return SCREEN_DONE;
     }
 
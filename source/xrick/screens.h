@@ -51,7 +51,9 @@ extern size_t screen_nbr_imaptext;
 extern U8 **screen_imaptext;  /* map intro texts */
 
 extern size_t screen_nbr_hiscores;
-extern hiscore_t *screen_highScores;  /* highest scores (hall of fame) */
+#define screen_highScores (game_ctx->screens.highScores)  /* highest scores (hall of fame) */
+
+#include "xrick/context.h"
 
 #ifdef GFXPC
 extern U8 *screen_imainhoft;  /* hall of fame title */
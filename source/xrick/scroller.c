@@ -21,11 +21,6 @@
 #include "xrick/maps.h"
 #include "xrick/ents.h"
 
-/*
- * Local variables
- */
-static U8 period;
-
 /*
  * Scroll up
  *
@@ -33,29 +28,28 @@ static U8 period;
 U8
 scroll_up(void)
 {
-  U8 i, j;
-  static U8 n = 0;
+  U8 i;
 
   /* last call: restore */
-  if (n == 8) {
-    n = 0;
-    game_period = period;
+  if (game_ctx->scroller.nUp == 8) {
+    game_ctx->scroller.nUp = 0;
+    game_period = game_ctx->scroller.period;
     return SCROLL_DONE;
   }
 
   /* first call: prepare */
-  if (n == 0) {
-    period = game_period;
+  if (game_ctx->scroller.nUp == 0) {
+    game_ctx->scroller.period = game_period;
     game_period = SCROLL_PERIOD;
   }
 
-  /* translate map */
-  for (i = MAP_ROW_SCRTOP; i < MAP_ROW_HBBOT; i++)
-    for (j = 0x00; j < 0x20; j++)
-      map_map[i][j] = map_map[i + 1][j];
+  /* translate map, only the row that comes in at the bottom is expanded */
+  map_frow++;
+  map_expand();
 
-  /* translate entities */
+  /* translate entities, and where they were drawn */
   for (i = 0; ent_ents[i].n != 0xFF; i++) {
+    ent_ents[i].prev_y -= 8;
     if (ent_ents[i].n) {
       ent_ents[i].ysave -= 8;
       ent_ents[i].trig_y -= 8;
@@ -70,21 +64,16 @@ scroll_up(void)
   }
 
   /* display */
-  draw_map();
+  draw_scrollMap(true);
   ent_draw();
   draw_drawStatus();
-  map_frow++;
 
   /* loop */
-  if (n++ == 7) {
+  if (game_ctx->scroller.nUp++ == 7) {
     /* activate visible entities */
     ent_actvis(map_frow + MAP_ROW_HBTOP, map_frow + MAP_ROW_HBBOT);
 
-    /* prepare map */
-    map_expand();
-
-    /* display */
-    draw_map();
+    /* display, map on screen is unchanged: just draw the newcomers */
     ent_draw();
     draw_drawStatus();
   }
@@ -101,29 +90,28 @@ scroll_up(void)
 U8
 scroll_down(void)
 {
-  U8 i, j;
-  static U8 n = 0;
+  U8 i;
 
   /* last call: restore */
-  if (n == 8) {
-    n = 0;
-    game_period = period;
+  if (game_ctx->scroller.nDown == 8) {
+    game_ctx->scroller.nDown = 0;
+    game_period = game_ctx->scroller.period;
     return SCROLL_DONE;
   }
 
   /* first call: prepare */
-  if (n == 0) {
-    period = game_period;
+  if (game_ctx->scroller.nDown == 0) {
+    game_ctx->scroller.period = game_period;
     game_period = SCROLL_PERIOD;
   }
 
-  /* translate map */
-  for (i = MAP_ROW_SCRBOT; i > MAP_ROW_HTTOP; i--)
-    for (j = 0x00; j < 0x20; j++)
-      map_map[i][j] = map_map[i - 1][j];
+  /* translate map, only the row that comes in at the top is expanded */
+  map_frow--;
+  map_expand();
 
-  /* translate entities */
+  /* translate entities, and where they were drawn */
   for (i = 0; ent_ents[i].n != 0xFF; i++) {
+    ent_ents[i].prev_y += 8;
     if (ent_ents[i].n) {
       ent_ents[i].ysave += 8;
       ent_ents[i].trig_y += 8;
@@ -138,21 +126,16 @@ scroll_down(void)
   }
 
   /* display */
-  draw_map();
+  draw_scrollMap(false);
   ent_draw();
   draw_drawStatus();
-  map_frow--;
 
   /* loop */
-  if (n++ == 7) {
+  if (game_ctx->scroller.nDown++ == 7) {
     /* activate visible entities */
     ent_actvis(map_frow + MAP_ROW_HTTOP, map_frow + MAP_ROW_HTBOT);
 
-    /* prepare map */
-    map_expand();
-
-    /* display */
-    draw_map();
+    /* display, map on screen is unchanged: just draw the newcomers */
     ent_draw();
     draw_drawStatus();
   }
@@ -0,0 +1,279 @@
+/*
+ * xrick/system/main_null.c
+ *
+ * Copyright (C) 2008-2014 Pierluigi Vicinanza. All rights reserved.
+ *
+ * The use and distribution terms for this software are contained in the file
+ * named README, which can be found in the root of this distribution. By
+ * using this software in any fashion, you are agreeing to be bound by the
+ * terms of this license.
+ *
+ * You must not remove this notice, or any other, from this software.
+ */
+
+#include "xrick/system/system.h"
+#include "xrick/system/system_null.h"
+#include "xrick/config.h"
+#include "xrick/context.h"
+#include "xrick/game.h"
+#include "xrick/draw.h"
+#include "xrick/bench.h"
+
+#ifdef ENABLE_THREADS
+
+#include "xrick/maps.h"
+#include "xrick/screens.h"
+
+#include <pthread.h>
+#include <stdlib.h>  /* calloc, malloc */
+#include <string.h>  /* memcpy, memset */
+#include <unistd.h>  /* sysconf */
+
+/*
+ * Local typedefs
+ */
+typedef struct
+{
+    game_context_t **contexts;  /* instances run by this worker */
+    U32 count;
+} worker_t;
+
+/*
+ * Step all instances of a worker, round robin, until they have all exited
+ */
+static void *
+workerRun(void *arg)
+{
+    worker_t *worker = arg;
+    U32 running = worker->count;
+    U32 i;
+
+    while (running)
+    {
+        running = 0;
+        for (i = 0; i < worker->count; ++i)
+        {
+            if (!worker->contexts[i])
+            {
+                continue;
+            }
+            game_ctx = worker->contexts[i];
+            if (game_step())
+            {
+                running++;
+            }
+            else
+            {
+                worker->contexts[i] = NULL;
+            }
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Set a context up, with its own frame buffer, draw buffers, entity marks
+ * and high scores
+ *
+ * Draw buffers come from the heap rather than from sysmem, which only has
+ * room for those of one game.
+ */
+static game_context_t *
+newContext(void)
+{
+    game_context_t *ctx = calloc(1, sizeof(*ctx));
+    size_t drawSize = draw_buffersSize();
+
+    if (!ctx)
+    {
+        return NULL;
+    }
+    ctx->fb = malloc(SYSVID_WIDTH * SYSVID_HEIGHT);
+    ctx->drawBuffers.block = drawSize ? malloc(drawSize) : NULL;
+    ctx->maps.marks = malloc(map_nbr_marks * sizeof(*ctx->maps.marks));
+    ctx->screens.highScores = malloc(screen_nbr_hiscores * sizeof(*ctx->screens.highScores));
+    if (!ctx->fb || (drawSize && !ctx->drawBuffers.block) ||
+        !ctx->maps.marks || !ctx->screens.highScores)
+    {
+        free(ctx->fb);
+        free(ctx->drawBuffers.block);
+        free(ctx->maps.marks);
+        free(ctx->screens.highScores);
+        free(ctx);
+        return NULL;
+    }
+    memset(ctx->fb, 0, SYSVID_WIDTH * SYSVID_HEIGHT);
+    memcpy(ctx->maps.marks, game_defaultContext.maps.marks,
+           map_nbr_marks * sizeof(*ctx->maps.marks));
+    memcpy(ctx->screens.highScores, game_defaultContext.screens.highScores,
+           screen_nbr_hiscores * sizeof(*ctx->screens.highScores));
+    return ctx;
+}
+
+static void
+deleteContext(game_context_t *ctx)
+{
+    free(ctx->fb);
+    free(ctx->drawBuffers.block);
+    free(ctx->maps.marks);
+    free(ctx->screens.highScores);
+    free(ctx);
+}
+
+/*
+ * Run sysarg_args_instances games side by side
+ *
+ * Resources are loaded once and shared. Each game gets a context of its
+ * own, then games are spread over as many threads as there are cores.
+ * There is no pacing: every thread runs its games as fast as it can.
+ */
+static bool
+runInstances(void)
+{
+    U32 n = sysarg_args_instances;
+    U32 k, i, inited, started;
+    long cores;
+    game_context_t **contexts;
+    game_context_t **slots;
+    worker_t *workers;
+    pthread_t *threads;
+    bool success = true;
+
+    cores = sysconf(_SC_NPROCESSORS_ONLN);
+    k = (cores < 1) ? 1 : (U32)cores;
+    if (k > n)
+    {
+        k = n;
+    }
+
+    contexts = calloc(n, sizeof(*contexts));
+    slots = calloc(n, sizeof(*slots));
+    workers = calloc(k, sizeof(*workers));
+    threads = calloc(k, sizeof(*threads));
+    if (!contexts || !slots || !workers || !threads)
+    {
+        sys_error("(main) instances malloc failed");
+        free(contexts);
+        free(slots);
+        free(workers);
+        free(threads);
+        return false;
+    }
+
+    if (!game_load())
+    {
+        free(contexts);
+        free(slots);
+        free(workers);
+        free(threads);
+        return false;
+    }
+
+    /* set games up, on this thread: replay buffers come from sysmem */
+    for (inited = 0; inited < n; ++inited)
+    {
+        contexts[inited] = newContext();
+        if (!contexts[inited])
+        {
+            sys_error("(main) context malloc failed");
+            success = false;
+            break;
+        }
+        game_ctx = contexts[inited];
+        if (!game_init())
+        {
+            inited++;  /* game_shutdown is due anyway */
+            success = false;
+            break;
+        }
+    }
+
+    if (success)
+    {
+        /* instance i goes to worker i % k, slots are grouped by worker */
+        U32 slot = 0;
+        for (i = 0; i < k; ++i)
+        {
+            U32 j;
+            workers[i].contexts = slots + slot;
+            for (j = i; j < n; j += k)
+            {
+                slots[slot++] = contexts[j];
+            }
+            workers[i].count = (U32)(slots + slot - workers[i].contexts);
+        }
+
+        for (started = 0; started < k; ++started)
+        {
+            if (pthread_create(&threads[started], NULL, workerRun, &workers[started]))
+            {
+                break;
+            }
+        }
+        /* workers that could not get a thread of their own run on this one */
+        for (i = started; i < k; ++i)
+        {
+            workerRun(&workers[i]);
+        }
+        for (i = 0; i < started; ++i)
+        {
+            pthread_join(threads[i], NULL);
+        }
+    }
+
+    /* tear games down in reverse order, sysmem is a stack */
+    sys_frames = 0;
+    while (inited--)
+    {
+        if (contexts[inited])
+        {
+            game_ctx = contexts[inited];
+            game_shutdown();
+            sys_frames += game_frames;
+            deleteContext(contexts[inited]);
+        }
+    }
+    game_ctx = &game_defaultContext;
+
+    game_unload();
+
+    free(contexts);
+    free(slots);
+    free(workers);
+    free(threads);
+    return success;
+}
+
+#endif /* ENABLE_THREADS */
+
+/*
+ * main
+ */
+int
+main(int argc, char *argv[])
+{
+    bool success = sys_init(argc, argv);
+    if (success)
+    {
+        if (sysarg_args_bench)
+        {
+            success = bench_run();
+        }
+        else
+#ifdef ENABLE_THREADS
+        if (sysarg_args_instances > 1)
+        {
+            success = runInstances();
+        }
+        else
+#endif /* ENABLE_THREADS */
+        {
+            game_run();
+            sys_frames = game_frames;
+        }
+    }
+    sys_shutdown();
+    return (success? 0 : 1);
+}
+
+/* eof */
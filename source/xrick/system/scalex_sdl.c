@@ -0,0 +1,538 @@
+/*
+ * xrick/system/scalex_sdl.c
+ *
+ * Copyright (C) 2008-2014 Pierluigi Vicinanza. All rights reserved.
+ *
+ * The use and distribution terms for this software are contained in the file
+ * named README, which can be found in the root of this distribution. By
+ * using this software in any fashion, you are agreeing to be bound by the
+ * terms of this license.
+ *
+ * You must not remove this notice, or any other, from this software.
+ */
+
+#include "xrick/system/scalex_sdl.h"
+
+#include "xrick/system/system.h"
+
+#include <string.h> /* memcpy, memset */
+#include <SDL.h>
+#include <SDL_thread.h>
+#ifdef __WIN32__
+#include <windows.h> /* GetSystemInfo */
+#else
+#include <unistd.h> /* sysconf */
+#endif
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+/*
+ * Local typedefs
+ */
+typedef struct
+{
+    U8 *dst;        /* screen pixels */
+    U32 pitch;
+    const U32 *lut; /* palette in screen pixels, NULL for 8 bits screens */
+    const U8 *src;  /* frame buffer */
+    rect_t rect;    /* in frame buffer pixels */
+    U8 zoom;
+    U8 kernel;      /* 2 or 3 */
+} job_t;
+
+typedef struct
+{
+    SDL_Thread *thread;
+    SDL_sem *start;
+    U16 top, bottom;  /* band, frame buffer rows */
+    U8 rows[3][SYSVID_WIDTH * 3];  /* kernel output, when pixels are replicated next */
+} worker_t;
+
+/*
+ * Local variables
+ */
+static job_t job;
+static worker_t workers[SCALEX_MAX_THREADS];  /* workers[0] is the caller */
+static U8 workersCount = 0;
+static SDL_sem *done = NULL;
+static bool quit = false;
+#if defined(__SSSE3__)
+static __m128i interleave3[3][3];  /* [output vector][input vector] shuffles */
+#endif
+
+/*
+ * Prototypes
+ */
+static int workerRun(void *);
+static void scaleBand(worker_t *);
+static void scale2xRow(U8 **, const U8 *, const U8 *, const U8 *, U16, U16);
+static void scale3xRow(U8 **, const U8 *, const U8 *, const U8 *, U16, U16);
+static U32 cpuCount(void);
+
+/*
+ * Start one worker thread per core, the caller being one of them
+ */
+bool
+scalex_init(void)
+{
+    U32 n = cpuCount();
+    U8 i;
+
+#if defined(__SSSE3__)
+    U8 o, v, j, mask[16];
+    for (o = 0; o < 3; o++)
+    {
+        for (v = 0; v < 3; v++)
+        {
+            for (j = 0; j < 16; j++)
+            {
+                U8 g = o * 16 + j;  /* output byte */
+                mask[j] = (g % 3 == v) ? g / 3 : 0x80;
+            }
+            interleave3[o][v] = _mm_loadu_si128((const __m128i *)mask);
+        }
+    }
+#endif
+
+    quit = false;
+    workersCount = 1;
+    done = SDL_CreateSemaphore(0);
+    if (!done)
+    {
+        return true;  /* caller alone */
+    }
+    for (i = 1; i < n && i < SCALEX_MAX_THREADS; i++)
+    {
+        workers[i].start = SDL_CreateSemaphore(0);
+        if (!workers[i].start)
+        {
+            break;
+        }
+        workers[i].thread = SDL_CreateThread(workerRun, &workers[i]);
+        if (!workers[i].thread)
+        {
+            SDL_DestroySemaphore(workers[i].start);
+            break;
+        }
+        workersCount++;
+    }
+    return true;
+}
+
+/*
+ * Stop worker threads
+ */
+void
+scalex_shutdown(void)
+{
+    U8 i;
+
+    quit = true;
+    for (i = 1; i < workersCount; i++)
+    {
+        SDL_SemPost(workers[i].start);
+        SDL_WaitThread(workers[i].thread, NULL);
+        SDL_DestroySemaphore(workers[i].start);
+    }
+    workersCount = 0;
+    if (done)
+    {
+        SDL_DestroySemaphore(done);
+        done = NULL;
+    }
+}
+
+/*
+ * Tell whether a zoom level can be scaled
+ */
+bool
+scalex_supports(U8 zoom)
+{
+    return (zoom % 3 == 0 || zoom % 2 == 0);
+}
+
+/*
+ * Scale a frame buffer rect to the screen
+ *
+ * dst: screen pixels, zoom times as wide and high as the frame buffer
+ * pitch: screen bytes per row
+ * src: frame buffer
+ * rect: rect to scale, grown by one pixel on each side on return
+ * zoom: zoom level, see scalex_supports
+ * lut: 32 bits screen pixel of each palette index, NULL for 8 bits screens
+ */
+void
+scalex_rect(U8 *dst, U32 pitch, const U8 *src, rect_t *rect, U8 zoom, const U32 *lut)
+{
+    U16 x0 = rect->x ? rect->x - 1 : 0;
+    U16 y0 = rect->y ? rect->y - 1 : 0;
+    U16 x1 = rect->x + rect->width < SYSVID_WIDTH ? rect->x + rect->width + 1 : SYSVID_WIDTH;
+    U16 y1 = rect->y + rect->height < SYSVID_HEIGHT ? rect->y + rect->height + 1 : SYSVID_HEIGHT;
+    U16 bands, i;
+
+    rect->x = x0;
+    rect->y = y0;
+    rect->width = x1 - x0;
+    rect->height = y1 - y0;
+
+    job.dst = dst;
+    job.pitch = pitch;
+    job.lut = lut;
+    job.src = src;
+    job.rect = *rect;
+    job.zoom = zoom;
+    job.kernel = (zoom % 3 == 0) ? 3 : 2;
+
+    /* split rows in bands, one per worker */
+    bands = rect->height / SCALEX_MIN_BAND;
+    if (bands > workersCount)
+    {
+        bands = workersCount;
+    }
+    if (bands < 1)
+    {
+        bands = 1;
+    }
+    for (i = 0; i < bands; i++)
+    {
+        workers[i].top = y0 + rect->height * i / bands;
+        workers[i].bottom = y0 + rect->height * (i + 1) / bands;
+    }
+
+    for (i = 1; i < bands; i++)
+    {
+        SDL_SemPost(workers[i].start);
+    }
+    scaleBand(&workers[0]);
+    for (i = 1; i < bands; i++)
+    {
+        SDL_SemWait(done);
+    }
+}
+
+/*
+ * Worker thread: scale bands until told to quit
+ */
+static int
+workerRun(void *arg)
+{
+    worker_t *worker = arg;
+
+    while (1)
+    {
+        SDL_SemWait(worker->start);
+        if (quit)
+        {
+            break;
+        }
+        scaleBand(worker);
+        SDL_SemPost(done);
+    }
+    return 0;
+}
+
+/*
+ * Scale the rows of a band. Rows above and below the band are read but
+ * not written: bands overlap by one row, for input only.
+ */
+static void
+scaleBand(worker_t *worker)
+{
+    U16 x = job.rect.x;
+    U16 width = job.rect.width;
+    U8 k = job.kernel;
+    U8 rep = job.zoom / k;  /* replication, after the kernel */
+    U8 bytes = job.lut ? 4 : 1;  /* per screen pixel */
+    bool direct = (rep == 1 && !job.lut);  /* kernel writes to the screen */
+    U8 *out[3];
+    U16 y, n;
+    U8 i, j;
+
+    for (y = worker->top; y < worker->bottom; y++)
+    {
+        const U8 *rowB = job.src + (y ? y - 1 : y) * SYSVID_WIDTH;
+        const U8 *rowE = job.src + y * SYSVID_WIDTH;
+        const U8 *rowH = job.src + (y + 1 < SYSVID_HEIGHT ? y + 1 : y) * SYSVID_WIDTH;
+        U8 *screen = job.dst + y * job.zoom * job.pitch + x * job.zoom * bytes;
+
+        for (i = 0; i < k; i++)
+        {
+            out[i] = direct ? screen + i * job.pitch : worker->rows[i];
+        }
+
+        if (k == 2)
+        {
+            scale2xRow(out, rowB, rowE, rowH, x, width);
+        }
+        else
+        {
+            scale3xRow(out, rowB, rowE, rowH, x, width);
+        }
+
+        if (direct)
+        {
+            continue;
+        }
+        for (i = 0; i < k; i++)  /* convert and replicate kernel output */
+        {
+            U8 *q = screen + i * rep * job.pitch;
+            if (job.lut)
+            {
+                U32 *q32 = (U32 *)q;
+                for (n = 0; n < width * k; n++)
+                {
+                    U32 c = job.lut[worker->rows[i][n]];
+                    for (j = 0; j < rep; j++)
+                    {
+                        *q32++ = c;
+                    }
+                }
+            }
+            else
+            {
+                for (n = 0; n < width * k; n++)
+                {
+                    memset(q + n * rep, worker->rows[i][n], rep);
+                }
+            }
+            for (j = 1; j < rep; j++)
+            {
+                memcpy(q + j * job.pitch, q, width * k * rep * bytes);
+            }
+        }
+    }
+}
+
+/*
+ * Scale2x, for one frame buffer row
+ *
+ *   A B C
+ *   D E F  E is scaled to  E0 E1
+ *   G H I                  E2 E3
+ *
+ * out: two screen rows, for E0 E1 and E2 E3
+ * rowB, rowE, rowH: frame buffer rows above, at and below
+ * x: first pixel, width: pixels count
+ */
+#define SCALE2X(X) \
+    do { \
+        U8 B = rowB[X], E = rowE[X], H = rowH[X]; \
+        U8 D = rowE[(X) ? (X) - 1 : (X)], F = rowE[(X) + 1 < SYSVID_WIDTH ? (X) + 1 : (X)]; \
+        U8 *q0 = out[0] + ((X) - x) * 2, *q1 = out[1] + ((X) - x) * 2; \
+        if (B != H && D != F) { \
+            q0[0] = D == B ? D : E; \
+            q0[1] = B == F ? F : E; \
+            q1[0] = D == H ? D : E; \
+            q1[1] = H == F ? F : E; \
+        } \
+        else { \
+            q0[0] = q0[1] = q1[0] = q1[1] = E; \
+        } \
+    } while (0)
+
+static void
+scale2xRow(U8 **out, const U8 *rowB, const U8 *rowE, const U8 *rowH, U16 x, U16 width)
+{
+    U16 end = x + width;
+    U16 i = x;
+
+    if (i == 0 && i < end)
+    {
+        SCALE2X(i);
+        i++;
+    }
+#if defined(__SSE2__)
+    for (; i + 16 <= end && i + 16 < SYSVID_WIDTH; i += 16)
+    {
+        __m128i B = _mm_loadu_si128((const __m128i *)(rowB + i));
+        __m128i E = _mm_loadu_si128((const __m128i *)(rowE + i));
+        __m128i H = _mm_loadu_si128((const __m128i *)(rowH + i));
+        __m128i D = _mm_loadu_si128((const __m128i *)(rowE + i - 1));
+        __m128i F = _mm_loadu_si128((const __m128i *)(rowE + i + 1));
+        __m128i no = _mm_or_si128(_mm_cmpeq_epi8(B, H), _mm_cmpeq_epi8(D, F));
+        __m128i m0 = _mm_andnot_si128(no, _mm_cmpeq_epi8(D, B));
+        __m128i m1 = _mm_andnot_si128(no, _mm_cmpeq_epi8(B, F));
+        __m128i m2 = _mm_andnot_si128(no, _mm_cmpeq_epi8(D, H));
+        __m128i m3 = _mm_andnot_si128(no, _mm_cmpeq_epi8(H, F));
+        __m128i e0 = _mm_or_si128(_mm_and_si128(m0, D), _mm_andnot_si128(m0, E));
+        __m128i e1 = _mm_or_si128(_mm_and_si128(m1, F), _mm_andnot_si128(m1, E));
+        __m128i e2 = _mm_or_si128(_mm_and_si128(m2, D), _mm_andnot_si128(m2, E));
+        __m128i e3 = _mm_or_si128(_mm_and_si128(m3, F), _mm_andnot_si128(m3, E));
+        U8 *q0 = out[0] + (i - x) * 2, *q1 = out[1] + (i - x) * 2;
+        _mm_storeu_si128((__m128i *)q0, _mm_unpacklo_epi8(e0, e1));
+        _mm_storeu_si128((__m128i *)(q0 + 16), _mm_unpackhi_epi8(e0, e1));
+        _mm_storeu_si128((__m128i *)q1, _mm_unpacklo_epi8(e2, e3));
+        _mm_storeu_si128((__m128i *)(q1 + 16), _mm_unpackhi_epi8(e2, e3));
+    }
+#elif defined(__ARM_NEON)
+    for (; i + 16 <= end && i + 16 < SYSVID_WIDTH; i += 16)
+    {
+        uint8x16_t B = vld1q_u8(rowB + i);
+        uint8x16_t E = vld1q_u8(rowE + i);
+        uint8x16_t H = vld1q_u8(rowH + i);
+        uint8x16_t D = vld1q_u8(rowE + i - 1);
+        uint8x16_t F = vld1q_u8(rowE + i + 1);
+        uint8x16_t no = vorrq_u8(vceqq_u8(B, H), vceqq_u8(D, F));
+        uint8x16x2_t e01, e23;
+        e01.val[0] = vbslq_u8(vbicq_u8(vceqq_u8(D, B), no), D, E);
+        e01.val[1] = vbslq_u8(vbicq_u8(vceqq_u8(B, F), no), F, E);
+        e23.val[0] = vbslq_u8(vbicq_u8(vceqq_u8(D, H), no), D, E);
+        e23.val[1] = vbslq_u8(vbicq_u8(vceqq_u8(H, F), no), F, E);
+        vst2q_u8(out[0] + (i - x) * 2, e01);
+        vst2q_u8(out[1] + (i - x) * 2, e23);
+    }
+#endif
+    for (; i < end; i++)
+    {
+        SCALE2X(i);
+    }
+}
+
+/*
+ * Scale3x, for one frame buffer row
+ *
+ *   A B C                  E0 E1 E2
+ *   D E F  E is scaled to  E3 E4 E5
+ *   G H I                  E6 E7 E8
+ *
+ * out: three screen rows
+ * rowB, rowE, rowH: frame buffer rows above, at and below
+ * x: first pixel, width: pixels count
+ */
+#define SCALE3X(X) \
+    do { \
+        U16 l = (X) ? (X) - 1 : (X), r = (X) + 1 < SYSVID_WIDTH ? (X) + 1 : (X); \
+        U8 A = rowB[l], B = rowB[X], C = rowB[r]; \
+        U8 D = rowE[l], E = rowE[X], F = rowE[r]; \
+        U8 G = rowH[l], H = rowH[X], I = rowH[r]; \
+        U8 *q0 = out[0] + ((X) - x) * 3, *q1 = out[1] + ((X) - x) * 3, *q2 = out[2] + ((X) - x) * 3; \
+        if (B != H && D != F) { \
+            q0[0] = D == B ? D : E; \
+            q0[1] = (D == B && E != C) || (B == F && E != A) ? B : E; \
+            q0[2] = B == F ? F : E; \
+            q1[0] = (D == B && E != G) || (D == H && E != A) ? D : E; \
+            q1[1] = E; \
+            q1[2] = (B == F && E != I) || (H == F && E != C) ? F : E; \
+            q2[0] = D == H ? D : E; \
+            q2[1] = (D == H && E != I) || (H == F && E != G) ? H : E; \
+            q2[2] = H == F ? F : E; \
+        } \
+        else { \
+            q0[0] = q0[1] = q0[2] = q1[0] = q1[1] = q1[2] = q2[0] = q2[1] = q2[2] = E; \
+        } \
+    } while (0)
+
+#if defined(__SSSE3__)
+#define SEL(M, A, B) _mm_or_si128(_mm_and_si128(M, A), _mm_andnot_si128(M, B))
+#define EQ(A, B) _mm_cmpeq_epi8(A, B)
+#define AND(A, B) _mm_and_si128(A, B)
+#define OR(A, B) _mm_or_si128(A, B)
+#define ANDNOT(M, A) _mm_andnot_si128(M, A)  /* A and not M */
+
+/*
+ * Store a[0] b[0] c[0] a[1] b[1] c[1]...
+ */
+static void
+store3(U8 *q, __m128i a, __m128i b, __m128i c)
+{
+    U8 o;
+
+    for (o = 0; o < 3; o++)
+    {
+        __m128i v = OR(OR(_mm_shuffle_epi8(a, interleave3[o][0]),
+                          _mm_shuffle_epi8(b, interleave3[o][1])),
+                       _mm_shuffle_epi8(c, interleave3[o][2]));
+        _mm_storeu_si128((__m128i *)(q + o * 16), v);
+    }
+}
+#elif defined(__ARM_NEON)
+#define SEL(M, A, B) vbslq_u8(M, A, B)
+#define EQ(A, B) vceqq_u8(A, B)
+#define AND(A, B) vandq_u8(A, B)
+#define OR(A, B) vorrq_u8(A, B)
+#define ANDNOT(M, A) vbicq_u8(A, M)  /* A and not M */
+
+static void
+store3(U8 *q, uint8x16_t a, uint8x16_t b, uint8x16_t c)
+{
+    uint8x16x3_t v;
+    v.val[0] = a;
+    v.val[1] = b;
+    v.val[2] = c;
+    vst3q_u8(q, v);
+}
+#endif
+
+static void
+scale3xRow(U8 **out, const U8 *rowB, const U8 *rowE, const U8 *rowH, U16 x, U16 width)
+{
+    U16 end = x + width;
+    U16 i = x;
+
+    if (i == 0 && i < end)
+    {
+        SCALE3X(i);
+        i++;
+    }
+#if defined(__SSSE3__) || (!defined(__SSE2__) && defined(__ARM_NEON))
+    for (; i + 16 <= end && i + 16 < SYSVID_WIDTH; i += 16)
+    {
+#if defined(__SSSE3__)
+#define LOAD(P) _mm_loadu_si128((const __m128i *)(P))
+        __m128i A, B, C, D, E, F, G, H, I, no, dB, bF, dH, hF;
+#else
+#define LOAD(P) vld1q_u8(P)
+        uint8x16_t A, B, C, D, E, F, G, H, I, no, dB, bF, dH, hF;
+#endif
+        A = LOAD(rowB + i - 1); B = LOAD(rowB + i); C = LOAD(rowB + i + 1);
+        D = LOAD(rowE + i - 1); E = LOAD(rowE + i); F = LOAD(rowE + i + 1);
+        G = LOAD(rowH + i - 1); H = LOAD(rowH + i); I = LOAD(rowH + i + 1);
+#undef LOAD
+        no = OR(EQ(B, H), EQ(D, F));
+        dB = ANDNOT(no, EQ(D, B));
+        bF = ANDNOT(no, EQ(B, F));
+        dH = ANDNOT(no, EQ(D, H));
+        hF = ANDNOT(no, EQ(H, F));
+        store3(out[0] + (i - x) * 3,
+               SEL(dB, D, E),
+               SEL(OR(ANDNOT(EQ(E, C), dB), ANDNOT(EQ(E, A), bF)), B, E),
+               SEL(bF, F, E));
+        store3(out[1] + (i - x) * 3,
+               SEL(OR(ANDNOT(EQ(E, G), dB), ANDNOT(EQ(E, A), dH)), D, E),
+               E,
+               SEL(OR(ANDNOT(EQ(E, I), bF), ANDNOT(EQ(E, C), hF)), F, E));
+        store3(out[2] + (i - x) * 3,
+               SEL(dH, D, E),
+               SEL(OR(ANDNOT(EQ(E, I), dH), ANDNOT(EQ(E, G), hF)), H, E),
+               SEL(hF, F, E));
+    }
+#endif
+    for (; i < end; i++)
+    {
+        SCALE3X(i);
+    }
+}
+
+/*
+ * Number of cores
+ */
+static U32
+cpuCount(void)
+{
+#ifdef __WIN32__
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors;
+#else
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return (n < 1) ? 1 : (U32)n;
+#endif
+}
+
+/* eof */
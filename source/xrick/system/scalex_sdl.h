@@ -0,0 +1,40 @@
+/*
+ * xrick/system/scalex_sdl.h
+ *
+ * Copyright (C) 2008-2014 Pierluigi Vicinanza. All rights reserved.
+ *
+ * The use and distribution terms for this software are contained in the file
+ * named README, which can be found in the root of this distribution. By
+ * using this software in any fashion, you are agreeing to be bound by the
+ * terms of this license.
+ *
+ * You must not remove this notice, or any other, from this software.
+ */
+
+#ifndef _SCALEX_SDL_H
+#define _SCALEX_SDL_H
+
+#include "xrick/system/basic_types.h"
+#include "xrick/rects.h"
+
+/*
+ * Scale2x and Scale3x pixel art scalers, on palette indices: they round
+ * edges off instead of replicating pixels. Zooms that are a multiple of
+ * 3 or 2 take Scale3x or Scale2x, then replicate pixels for the rest.
+ *
+ * Rects are split in bands of rows, scaled by worker threads along with
+ * the caller. Output pixels depend on their neighbours, so rects grow by
+ * one pixel on each side before being scaled. On 32 bits screens, pixels
+ * go through the palette lookup table as they are written.
+ */
+#define SCALEX_MAX_THREADS 16
+#define SCALEX_MIN_BAND 8  /* rows, smaller bands are not worth a thread */
+
+extern bool scalex_init(void);
+extern void scalex_shutdown(void);
+extern bool scalex_supports(U8);
+extern void scalex_rect(U8 *, U32, const U8 *, rect_t *, U8, const U32 *);
+
+#endif /* ndef _SCALEX_SDL_H */
+
+/* eof */
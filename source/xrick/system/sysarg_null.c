@@ -0,0 +1,434 @@
+/*
+ * xrick/system/sysarg_null.c
+ *
+ * Copyright (C) 2008-2014 Pierluigi Vicinanza. All rights reserved.
+ *
+ * The use and distribution terms for this software are contained in the file
+ * named README, which can be found in the root of this distribution. By
+ * using this software in any fashion, you are agreeing to be bound by the
+ * terms of this license.
+ *
+ * You must not remove this notice, or any other, from this software.
+ */
+
+#include "xrick/system/system.h"
+#include "xrick/system/system_null.h"
+#include "xrick/config.h"
+#include "xrick/game.h"
+
+#include <stdlib.h>  /* atoi */
+#include <string.h>  /* strcmp */
+
+int sysarg_args_period = 0;
+int sysarg_args_map = 0;
+int sysarg_args_submap = 0;
+int sysarg_args_turbo = 0;
+#ifdef ENABLE_SOUND
+bool sysarg_args_nosound = true;
+#endif /* ENABLE_SOUND */
+const char *sysarg_args_data = NULL;
+const char *sysarg_args_load = NULL;
+#ifdef ENABLE_REPLAY
+const char *sysarg_args_record = NULL;
+const char *sysarg_args_replay = NULL;
+U32 sysarg_args_replayFrom = 0;
+#endif /* ENABLE_REPLAY */
+#ifdef ENABLE_REWIND
+U32 sysarg_args_rewind = 0;
+#endif /* ENABLE_REWIND */
+#ifdef ENABLE_PROFILER
+const char *sysarg_args_profile = NULL;
+#endif /* ENABLE_PROFILER */
+bool sysarg_args_fast = false;
+U32 sysarg_args_frames = 0;
+U32 sysarg_args_instances = 1;
+const char *sysarg_args_save = NULL;
+bool sysarg_args_bench = false;
+
+/*
+ * Version info
+ */
+static void sysarg_version(void)
+{
+    sys_printf(
+        "xrick-headless version '%s'\n\n"
+        " Copyright (C) 1998-2002 BigOrno (bigorno@bigorno.net).\n"
+        " Copyright (C) 2008-2014 Pierluigi Vicinanza.\n"
+        " All rights reserved.\n\n"
+        " The use and distribution terms for this software are contained in the file\n"
+        " named README, which can be found in the root of this distribution. By\n"
+        " using this software in any fashion, you are agreeing to be bound by the\n"
+        " terms of this license.\n\n", XRICK_VERSION_STR);
+}
+
+/*
+ * Help
+ */
+static void sysarg_help(void)
+{
+   sys_printf(
+       "Usage: xrick-headless [option(s)]\n"
+       " The options are:\n\n"
+       "  -h, --help         Display this information\n"
+       "  --speed <speed>    Run at speed <speed>. <speed> must be \n"
+       "                     an integer between 1 (fast) and 100 (slow).\n"
+       "                     The default is %d.\n"
+       "  --turbo <ticks>    Fast forward: run <ticks> game ticks per displayed\n"
+       "                     frame, drawing only the last one. <ticks> must be\n"
+       "                     an integer between 2 and 100.\n"
+       "  --fast             Ignore speed and run frames back to back,\n"
+       "                     as fast as the CPU allows.\n"
+       "  --frames <frames>  Exit after <frames> frames.\n"
+       "                     The default is to run until the game exits.\n"
+       "  --save <file>      Write a game snapshot to <file> once\n"
+       "                     <frames> frames have run, then exit.\n"
+#ifdef ENABLE_THREADS
+       "  --instances <n>    Run <n> independent games side by side,\n"
+       "                     on as many threads as there are cores.\n"
+       "                     Implies --fast. The default is 1.\n"
+#endif /* ENABLE_THREADS */
+       "  --map <map>        Start at map number <map>.\n"
+       "                     <map> must be an integer between 1 and %d.\n"
+       "                     The default is to start at map number 1.\n"
+       "  --submap <submap>  Start at submap <submap>.\n"
+       "                     <submap> must be an integer between 1 and %d.\n"
+       "                     The default is to start at submap number 1\n"
+       "                     or, if a map was specified,\n"
+       "                     at the first submap of that map.\n"
+       "  --data <archive>   Use data archive <archive>\n"
+       "                     <archive> must be either a zip file or\n"
+       "                     a directory. The default is to look for \"data.zip\"\n"
+       "                     in the directory where xrick is run from.\n"
+       "  --load <file>      Start from game snapshot <file>.\n"
+#ifdef ENABLE_REPLAY
+       "  --record <file>    Record inputs to replay file <file>.\n"
+       "  --replay <file>    Play back inputs from replay file <file>.\n"
+       "                     Speed, map and submap are those of the recording.\n"
+       "  --replay-from <n>  Start playback at frame <n>, from the keyframe\n"
+       "                     before it.\n"
+#endif /* ENABLE_REPLAY */
+#ifdef ENABLE_REWIND
+       "  --rewind <kbytes>  Keep the last frames of play in a <kbytes> KB\n"
+       "                     rewind buffer. With --frames, the last second\n"
+       "                     is spent rewinding, and rewind memory usage\n"
+       "                     and latency are reported on exit.\n"
+#endif /* ENABLE_REWIND */
+#ifdef ENABLE_PROFILER
+       "  --profile <file>   Time game states and frame phases, report frames\n"
+       "                     taking longer than their period, and write\n"
+       "                     latency distributions to CSV file <file> on exit.\n"
+#endif /* ENABLE_PROFILER */
+       "  --bench            Time micro-benchmarks of map and drawing code,\n"
+       "                     then exit.\n"
+       "  --version          Print version information.\n\n",
+       GAME_PERIOD, 5/*MAP_NBR_MAPS*/-1, 47/*MAP_NBR_SUBMAPS*/
+       );
+}
+
+/*
+ * Fail
+ */
+static void sysarg_fail(char *msg)
+{
+    sys_printf(
+        "xrick-headless: %s\n"
+        " Use 'xrick-headless --help' for a complete list of options.\n", msg);
+}
+
+/*
+ * Read and process arguments
+ */
+bool
+sysarg_init(int argc, char **argv)
+{
+    int i;
+
+    for (i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--help") ||
+            !strcmp(argv[i], "-h"))
+        {
+            sysarg_help();
+            return false;
+        }
+        else if (!strcmp(argv[i], "--speed"))
+        {
+            if (++i == argc)
+            {
+                sysarg_fail("missing speed value");
+                return false;
+            }
+            sysarg_args_period = atoi(argv[i]) - 1;
+            if (sysarg_args_period < 0 || sysarg_args_period > 99)
+            {
+                sysarg_fail("invalid speed value");
+                return false;
+            }
+        }
+        else if (!strcmp(argv[i], "--turbo"))
+        {
+            if (++i == argc)
+            {
+                sysarg_fail("missing turbo ticks count");
+                return false;
+            }
+            sysarg_args_turbo = atoi(argv[i]);
+            if (sysarg_args_turbo < 2 || sysarg_args_turbo > 100)
+            {
+                sysarg_fail("invalid turbo ticks count");
+                return false;
+            }
+        }
+        else if (!strcmp(argv[i], "--fast"))
+        {
+            sysarg_args_fast = true;
+        }
+        else if (!strcmp(argv[i], "--frames"))
+        {
+            if (++i == argc)
+            {
+                sysarg_fail("missing frames count");
+                return false;
+            }
+            if (atoi(argv[i]) < 1)
+            {
+                sysarg_fail("invalid frames count");
+                return false;
+            }
+            sysarg_args_frames = atoi(argv[i]);
+        }
+#ifdef ENABLE_THREADS
+        else if (!strcmp(argv[i], "--instances"))
+        {
+            if (++i == argc)
+            {
+                sysarg_fail("missing instances count");
+                return false;
+            }
+            if (atoi(argv[i]) < 1)
+            {
+                sysarg_fail("invalid instances count");
+                return false;
+            }
+            sysarg_args_instances = atoi(argv[i]);
+        }
+#endif /* ENABLE_THREADS */
+        else if (!strcmp(argv[i], "--map"))
+        {
+            if (++i == argc)
+            {
+                sysarg_fail("missing map number");
+                return false;
+            }
+            sysarg_args_map = atoi(argv[i]) - 1;
+            if (sysarg_args_map < 0 || sysarg_args_map >= 5/*MAP_NBR_MAPS*/-1) /* TODO: remove hardcoded map max count */
+            {
+                sysarg_fail("invalid map number");
+                return false;
+            }
+        }
+        else if (!strcmp(argv[i], "--submap"))
+        {
+            if (++i == argc)
+            {
+                sysarg_fail("missing submap number");
+                return false;
+            }
+            sysarg_args_submap = atoi(argv[i]) - 1;
+            if (sysarg_args_submap < 0 || sysarg_args_submap >= 47/*MAP_NBR_SUBMAPS*/) /* TODO: remove hardcoded submap max count */
+            {
+                sysarg_fail("invalid submap number");
+                return false;
+            }
+        }
+        else if (!strcmp(argv[i], "--data"))
+        {
+            if (++i == argc)
+            {
+                sysarg_fail("missing data");
+                return false;
+            }
+            sysarg_args_data = argv[i];
+        }
+        else if (!strcmp(argv[i], "--save"))
+        {
+            if (++i == argc)
+            {
+                sysarg_fail("missing snapshot file");
+                return false;
+            }
+            sysarg_args_save = argv[i];
+        }
+        else if (!strcmp(argv[i], "--load"))
+        {
+            if (++i == argc)
+            {
+                sysarg_fail("missing snapshot file");
+                return false;
+            }
+            sysarg_args_load = argv[i];
+        }
+#ifdef ENABLE_REPLAY
+        else if (!strcmp(argv[i], "--record"))
+        {
+            if (++i == argc)
+            {
+                sysarg_fail("missing replay file");
+                return false;
+            }
+            sysarg_args_record = argv[i];
+        }
+        else if (!strcmp(argv[i], "--replay"))
+        {
+            if (++i == argc)
+            {
+                sysarg_fail("missing replay file");
+                return false;
+            }
+            sysarg_args_replay = argv[i];
+        }
+        else if (!strcmp(argv[i], "--replay-from"))
+        {
+            if (++i == argc)
+            {
+                sysarg_fail("missing frame number");
+                return false;
+            }
+            if (atoi(argv[i]) < 1)
+            {
+                sysarg_fail("invalid frame number");
+                return false;
+            }
+            sysarg_args_replayFrom = atoi(argv[i]);
+        }
+#endif /* ENABLE_REPLAY */
+#ifdef ENABLE_REWIND
+        else if (!strcmp(argv[i], "--rewind"))
+        {
+            if (++i == argc)
+            {
+                sysarg_fail("missing rewind buffer size");
+                return false;
+            }
+            if (atoi(argv[i]) < 1)
+            {
+                sysarg_fail("invalid rewind buffer size");
+                return false;
+            }
+            sysarg_args_rewind = atoi(argv[i]);
+        }
+#endif /* ENABLE_REWIND */
+#ifdef ENABLE_PROFILER
+        else if (!strcmp(argv[i], "--profile"))
+        {
+            if (++i == argc)
+            {
+                sysarg_fail("missing profile file");
+                return false;
+            }
+            sysarg_args_profile = argv[i];
+        }
+#endif /* ENABLE_PROFILER */
+        else if (!strcmp(argv[i], "--bench"))
+        {
+            sysarg_args_bench = true;
+        }
+        else if (!strcmp(argv[i], "--version"))
+        {
+            sysarg_version();
+            return false;
+        }
+        else
+        {
+            char message[128];
+            sys_snprintf(message, sizeof(message), "unrecognized option '%s'", argv[i]);
+            sysarg_fail(message);
+            return false;
+        }
+    }
+
+#ifdef ENABLE_REPLAY
+    if (sysarg_args_record && sysarg_args_replay)
+    {
+        sysarg_fail("can not record and replay at the same time");
+        return false;
+    }
+    if (sysarg_args_load && (sysarg_args_record || sysarg_args_replay))
+    {
+        sysarg_fail("can not start from a snapshot when recording or replaying");
+        return false;
+    }
+    if (sysarg_args_replayFrom && !sysarg_args_replay)
+    {
+        sysarg_fail("can not start playback at a frame without a replay");
+        return false;
+    }
+    if (sysarg_args_record && sysarg_args_instances > 1)
+    {
+        sysarg_fail("can not record more than one instance");
+        return false;
+    }
+#endif /* ENABLE_REPLAY */
+#ifdef ENABLE_REWIND
+#ifdef ENABLE_REPLAY
+    if (sysarg_args_rewind && (sysarg_args_record || sysarg_args_replay))
+    {
+        sysarg_fail("can not rewind when recording or replaying");
+        return false;
+    }
+#endif /* ENABLE_REPLAY */
+    if (sysarg_args_rewind && sysarg_args_instances > 1)
+    {
+        sysarg_fail("can not rewind more than one instance");
+        return false;
+    }
+#endif /* ENABLE_REWIND */
+#ifdef ENABLE_PROFILER
+    if (sysarg_args_profile && sysarg_args_instances > 1)
+    {
+        sysarg_fail("can not profile more than one instance");
+        return false;
+    }
+#endif /* ENABLE_PROFILER */
+    if (sysarg_args_save && !sysarg_args_frames)
+    {
+        sysarg_fail("can not save a snapshot without a frames count");
+        return false;
+    }
+    if (sysarg_args_save && sysarg_args_instances > 1)
+    {
+        sysarg_fail("can not save more than one instance");
+        return false;
+    }
+    if (sysarg_args_instances > 1)
+    {
+        sysarg_args_fast = true;
+    }
+
+    /* same as SDL version: derive map from submap */
+    if (sysarg_args_submap > 0 && sysarg_args_submap < 9)
+    {
+        sysarg_args_map = 0;
+    }
+    if (sysarg_args_submap >= 9 && sysarg_args_submap < 20)
+    {
+        sysarg_args_map = 1;
+    }
+    if (sysarg_args_submap >= 20 && sysarg_args_submap < 38)
+    {
+        sysarg_args_map = 2;
+    }
+    if (sysarg_args_submap >= 38)
+    {
+        sysarg_args_map = 3;
+    }
+    if (sysarg_args_submap == 9 ||
+        sysarg_args_submap == 20 ||
+        sysarg_args_submap == 38)
+    {
+        sysarg_args_submap = 0;
+    }
+    return true;
+}
+
+/* eof */
@@ -30,8 +30,10 @@
 int sysarg_args_period = 0; /* time between each frame, in milliseconds. The default is 40. */
 int sysarg_args_map = 0;
 int sysarg_args_submap = 0;
+int sysarg_args_turbo = 0;
 bool sysarg_args_nosound = false;
 const char *sysarg_args_data = NULL;
+const char *sysarg_args_load = NULL;
 
 /*
  * Read and process arguments
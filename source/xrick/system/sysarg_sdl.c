@@ -34,6 +34,8 @@
 #define strcasecmp _stricmp
 #endif
 
+#define SYSARG_REWIND 48  /* default rewind buffer size, in KB */
+
 typedef struct {
   char name[16];
   int code;
@@ -46,11 +48,26 @@ static sdlcodes_t sdlcodes[SDLK_LAST] = {
 int sysarg_args_period = 0;
 int sysarg_args_map = 0;
 int sysarg_args_submap = 0;
+int sysarg_args_turbo = 0;
 int sysarg_args_fullscreen = 0;
 int sysarg_args_zoom = 0;
+bool sysarg_args_scalex = false;
+int sysarg_args_bpp = 0;
 bool sysarg_args_nosound = false;
 int sysarg_args_vol = 0;
 const char *sysarg_args_data = NULL;
+const char *sysarg_args_load = NULL;
+#ifdef ENABLE_REPLAY
+const char *sysarg_args_record = NULL;
+const char *sysarg_args_replay = NULL;
+U32 sysarg_args_replayFrom = 0;
+#endif /* ENABLE_REPLAY */
+#ifdef ENABLE_REWIND
+U32 sysarg_args_rewind = SYSARG_REWIND;
+#endif /* ENABLE_REWIND */
+#ifdef ENABLE_PROFILER
+const char *sysarg_args_profile = NULL;
+#endif /* ENABLE_PROFILER */
 
 /*
  * Version info
@@ -82,9 +99,19 @@ static void sysarg_help(void)
        "  --speed <speed>    Run at speed <speed>. <speed> must be \n"
        "                     an integer between 1 (fast) and 100 (slow).\n"
        "                     The default is %d.\n"
+       "  --turbo <ticks>    Fast forward: run <ticks> game ticks per displayed\n"
+       "                     frame, drawing only the last one. <ticks> must be\n"
+       "                     an integer between 2 and 100. Without this option,\n"
+       "                     holding TAB runs %d ticks per displayed frame.\n"
        "  --zoom <zoom>      Display with zoom factor <zoom>.\n"
        "                     <zoom> must be an integer between 1 (320x200)\n"
        "                     and %d (%d times bigger). The default is %d.\n"
+       "  --bpp <bpp>        Display at <bpp> bits per pixel, 8 (palette)\n"
+       "                     or 32 (true colour). The default is 32 if the\n"
+       "                     display is 32 bits deep, else 8.\n"
+       "  --scalex           Smooth edges with Scale2x or Scale3x instead of\n"
+       "                     replicating pixels, at zoom levels that are a\n"
+       "                     multiple of 2 or 3. Scaling runs on all cores.\n"
        "  --map <map>        Start at map number <map>.\n"
        "                     <map> must be an integer between 1 and %d.\n"
        "                     The default is to start at map number 1.\n"
@@ -100,6 +127,25 @@ static void sysarg_help(void)
        "                     <archive> must be either a zip file or\n"
        "                     a directory. The default is to look for \"data.zip\"\n"
        "                     in the directory where xrick is run from.\n"
+       "  --load <file>      Start from game snapshot <file>.\n"
+#ifdef ENABLE_REPLAY
+       "  --record <file>    Record inputs to replay file <file>.\n"
+       "  --replay <file>    Play back inputs from replay file <file>.\n"
+       "                     Speed, map and submap are those of the recording.\n"
+       "  --replay-from <n>  Start playback at frame <n>, from the keyframe\n"
+       "                     before it.\n"
+#endif /* ENABLE_REPLAY */
+#ifdef ENABLE_REWIND
+       "  --rewind <kbytes>  Keep the last frames of play in a <kbytes> KB\n"
+       "                     rewind buffer, 0 disables rewind. Hold\n"
+       "                     BACKSPACE to go back in time. The default is %d.\n"
+       "                     Rewind is disabled when recording or replaying.\n"
+#endif /* ENABLE_REWIND */
+#ifdef ENABLE_PROFILER
+       "  --profile <file>   Time game states and frame phases, report frames\n"
+       "                     taking longer than their period, and write\n"
+       "                     latency distributions to CSV file <file> on exit.\n"
+#endif /* ENABLE_PROFILER */
 #ifdef ENABLE_SOUND
        "  --nosound          Disable sounds.\n"
        "                     The default is to play with sounds enabled.\n"
@@ -109,7 +155,10 @@ static void sysarg_help(void)
        "                     at maximum volume (%d).\n"
 #endif /* ENABLE_SOUND */
        "  --version          Print version information.\n\n",
-       GAME_PERIOD, SYSVID_MAXZOOM, SYSVID_MAXZOOM, SYSVID_ZOOM, 5/*MAP_NBR_MAPS*/-1, 47/*MAP_NBR_SUBMAPS*/
+       GAME_PERIOD, GAME_TURBO, SYSVID_MAXZOOM, SYSVID_MAXZOOM, SYSVID_ZOOM, 5/*MAP_NBR_MAPS*/-1, 47/*MAP_NBR_SUBMAPS*/
+#ifdef ENABLE_REWIND
+       , SYSARG_REWIND
+#endif /* ENABLE_REWIND */
 #ifdef ENABLE_SOUND
        , SYSSND_MAXVOL, SYSSND_MAXVOL
 #endif /* ENABLE_SOUND */
@@ -210,6 +259,10 @@ sysarg_init(int argc, char **argv)
         {
             sysarg_args_fullscreen = 1;
         }
+        else if (!strcmp(argv[i], "--scalex"))
+        {
+            sysarg_args_scalex = true;
+        }
         else if (!strcmp(argv[i], "--help") ||
                  !strcmp(argv[i], "-h"))
         {
@@ -230,6 +283,20 @@ sysarg_init(int argc, char **argv)
                 return false;
             }
         }
+        else if (!strcmp(argv[i], "--turbo"))
+        {
+            if (++i == argc)
+            {
+                sysarg_fail("missing turbo ticks count");
+                return false;
+            }
+            sysarg_args_turbo = atoi(argv[i]);
+            if (sysarg_args_turbo < 2 || sysarg_args_turbo > 100)
+            {
+                sysarg_fail("invalid turbo ticks count");
+                return false;
+            }
+        }
         else if (!strcmp(argv[i], "--keys"))
         {
             if (++i == argc)
@@ -257,6 +324,20 @@ sysarg_init(int argc, char **argv)
                 return false;
             }
         }
+        else if (!strcmp(argv[i], "--bpp"))
+        {
+            if (++i == argc)
+            {
+                sysarg_fail("missing bpp value");
+                return false;
+            }
+            sysarg_args_bpp = atoi(argv[i]);
+            if (sysarg_args_bpp != 8 && sysarg_args_bpp != 32)
+            {
+                sysarg_fail("invalid bpp value");
+                return false;
+            }
+        }
         else if (!strcmp(argv[i], "--map"))
         {
             if (++i == argc)
@@ -314,6 +395,76 @@ sysarg_init(int argc, char **argv)
             }
             sysarg_args_data = argv[i];
         }
+        else if (!strcmp(argv[i], "--load"))
+        {
+            if (++i == argc)
+            {
+                sysarg_fail("missing snapshot file");
+                return false;
+            }
+            sysarg_args_load = argv[i];
+        }
+#ifdef ENABLE_REPLAY
+        else if (!strcmp(argv[i], "--record"))
+        {
+            if (++i == argc)
+            {
+                sysarg_fail("missing replay file");
+                return false;
+            }
+            sysarg_args_record = argv[i];
+        }
+        else if (!strcmp(argv[i], "--replay"))
+        {
+            if (++i == argc)
+            {
+                sysarg_fail("missing replay file");
+                return false;
+            }
+            sysarg_args_replay = argv[i];
+        }
+        else if (!strcmp(argv[i], "--replay-from"))
+        {
+            if (++i == argc)
+            {
+                sysarg_fail("missing frame number");
+                return false;
+            }
+            if (atoi(argv[i]) < 1)
+            {
+                sysarg_fail("invalid frame number");
+                return false;
+            }
+            sysarg_args_replayFrom = atoi(argv[i]);
+        }
+#endif /* ENABLE_REPLAY */
+#ifdef ENABLE_REWIND
+        else if (!strcmp(argv[i], "--rewind"))
+        {
+            if (++i == argc)
+            {
+                sysarg_fail("missing rewind buffer size");
+                return false;
+            }
+            if (atoi(argv[i]) < 0)
+            {
+                sysarg_fail("invalid rewind buffer size");
+                return false;
+            }
+            sysarg_args_rewind = atoi(argv[i]);
+        }
+#endif /* ENABLE_REWIND */
+#ifdef ENABLE_PROFILER
+        else if (!strcmp(argv[i], "--profile"))
+        {
+            if (++i == argc)
+            {
+                sysarg_fail("missing profile file");
+                return false;
+            }
+            sysarg_args_profile = argv[i];
+        }
+#endif /* ENABLE_PROFILER */
         else if (!strcmp(argv[i], "--version"))
         {
             sysarg_version();
@@ -328,6 +479,30 @@ sysarg_init(int argc, char **argv)
         }
     }
 
+#ifdef ENABLE_REPLAY
+    if (sysarg_args_record && sysarg_args_replay)
+    {
+        sysarg_fail("can not record and replay at the same time");
+        return false;
+    }
+    if (sysarg_args_load && (sysarg_args_record || sysarg_args_replay))
+    {
+        sysarg_fail("can not start from a snapshot when recording or replaying");
+        return false;
+    }
+    if (sysarg_args_replayFrom && !sysarg_args_replay)
+    {
+        sysarg_fail("can not start playback at a frame without a replay");
+        return false;
+    }
+#ifdef ENABLE_REWIND
+    if (sysarg_args_record || sysarg_args_replay)
+    {
+        sysarg_args_rewind = 0;  /* rewinding would not replay */
+    }
+#endif /* ENABLE_REWIND */
+#endif /* ENABLE_REPLAY */
+
     /* TODO: remove checks below based on hardcoded values.
     *       Add code to check sysarg_args_map and sysarg_args_submap against map/submap max counts
     *       (after these have been loaded from resource files).
@@ -0,0 +1,39 @@
+/*
+ * xrick/system/sysevt_null.c
+ *
+ * Copyright (C) 2008-2014 Pierluigi Vicinanza. All rights reserved.
+ *
+ * The use and distribution terms for this software are contained in the file
+ * named README, which can be found in the root of this distribution. By
+ * using this software in any fashion, you are agreeing to be bound by the
+ * terms of this license.
+ *
+ * You must not remove this notice, or any other, from this software.
+ */
+
+#include "xrick/system/system.h"
+#include "xrick/system/system_null.h"
+
+/*
+ * Process events, if any, then return
+ *
+ * There is no input device: only account for the frame.
+ */
+void
+sysevt_poll(void)
+{
+    sys_tick();
+}
+
+/*
+ * Wait for an event, then process it and return
+ *
+ * Nothing will ever come, so do not block.
+ */
+void
+sysevt_wait(void)
+{
+    sys_tick();
+}
+
+/* eof */
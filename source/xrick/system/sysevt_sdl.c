@@ -29,6 +29,7 @@
 #include "xrick/draw.h"
 
 #define SYSJOY_RANGE 3280
+#define SYSEVT_QUICKSAVE "xrick.sav"  /* F10 saves a game snapshot there, F11 loads it */
 
 static SDL_Event event;
 
@@ -70,6 +71,14 @@ processEvent()
     else if (key == syskbd_fire) {
       control_set(Control_FIRE);
     }
+#ifdef ENABLE_REWIND
+    else if (key == SDLK_BACKSPACE) {
+      control_set(Control_REWIND);
+    }
+#endif
+    else if (key == SDLK_TAB) {
+      control_set(Control_TURBO);
+    }
     else if (key == SDLK_F1) {
       sysvid_toggleFullscreen();
     }
@@ -101,6 +110,12 @@ processEvent()
       game_toggleCheat(Cheat_EXPOSE);
     }
 #endif
+    else if (key == SDLK_F10) {
+      game_saveSnapshot(SYSEVT_QUICKSAVE);
+    }
+    else if (key == SDLK_F11) {
+      game_loadSnapshot(SYSEVT_QUICKSAVE);
+    }
     break;
   case SDL_KEYUP:
     key = event.key.keysym.sym;
@@ -128,6 +143,14 @@ processEvent()
     else if (key == syskbd_fire) {
       control_clear(Control_FIRE);
     }
+#ifdef ENABLE_REWIND
+    else if (key == SDLK_BACKSPACE) {
+      control_clear(Control_REWIND);
+    }
+#endif
+    else if (key == SDLK_TAB) {
+      control_clear(Control_TURBO);
+    }
     break;
   case SDL_QUIT:
     /* player tries to close the window -- this is the same as pressing ESC */
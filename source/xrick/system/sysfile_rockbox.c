@@ -119,4 +119,101 @@ void sysfile_close(file_t file)
     rb->close(fd);
 }
 
+/*
+ * Open a local file, i.e. a file outside of the data archive.
+ */
+file_t sysfile_openLocal(const char *name, bool write)
+{
+    int fd;
+
+    if (write)
+    {
+        fd = rb->open(name, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    }
+    else
+    {
+        fd = rb->open(name, O_RDONLY);
+    }
+
+    if (fd == 0)
+    {
+        sys_error("(file) unsupported file descriptor (zero/NULL) being used");
+    }
+    if (fd < 0)
+    {
+        return NULL;
+    }
+
+    return (file_t)fd;
+}
+
+/*
+ * Read a local file.
+ */
+int sysfile_readLocal(file_t file, void *buf, size_t size, size_t count)
+{
+    return sysfile_read(file, buf, size, count);
+}
+
+/*
+ * Write a local file.
+ */
+int sysfile_writeLocal(file_t file, const void *buf, size_t size, size_t count)
+{
+    int fd = (int)file;
+    return (rb->write(fd, buf, size * count) / size);
+}
+
+/*
+ * Seek in a local file. Return 0 on success, like fseek.
+ */
+int sysfile_seekLocal(file_t file, long offset, int origin)
+{
+    int fd = (int)file;
+    return (rb->lseek(fd, offset, origin) < 0) ? -1 : 0;
+}
+
+/*
+ * Close a local file.
+ */
+void sysfile_closeLocal(file_t file)
+{
+    sysfile_close(file);
+}
+
+/*
+ * Map a local file in memory, read-only.
+ *
+ * There is no mmap: the file is read into a block of the memory stack.
+ */
+const void *sysfile_mapLocal(const char *name, size_t *size)
+{
+    int fd;
+    U8 *buf;
+
+    fd = rb->open(name, O_RDONLY);
+    if (fd < 0)
+    {
+        return NULL;
+    }
+    *size = rb->filesize(fd);
+    buf = sysmem_push(*size);
+    if (buf && rb->read(fd, buf, *size) != (ssize_t)*size)
+    {
+        sysmem_pop(buf);
+        buf = NULL;
+    }
+    rb->close(fd);
+    return buf;
+}
+
+/*
+ * Unmap a local file.
+ */
+void sysfile_unmapLocal(const void *buf, size_t size)
+{
+    (void)size;
+    sysmem_pop((void *)buf);
+}
+
 /* eof */
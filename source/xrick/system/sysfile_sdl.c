@@ -23,6 +23,9 @@
 #include <stdio.h>  /* sprintf fileno */
 #include <string.h> /* strlen */
 #include <sys/stat.h> /* fstat */
+#ifndef _WIN32
+#include <sys/mman.h> /* mmap */
+#endif
 
 /* handle Microsoft Visual C */
 #ifdef _MSC_VER
@@ -251,6 +254,116 @@ sysfile_close(file_t file)
     }
 }
 
+/*
+ * Open a local file, i.e. a file outside of the data archive.
+ */
+file_t
+sysfile_openLocal(const char *name, bool write)
+{
+    FILE *fh;
+    char *path = u_strdup(name);
+    if (!path)
+    {
+        return NULL;
+    }
+    str_toNativeSeparators(path);
+    fh = fopen(path, write ? "wb" : "rb");
+    sysmem_pop(path);
+    return (file_t)fh;
+}
+
+/*
+ * Read a local file.
+ */
+int
+sysfile_readLocal(file_t file, void *buf, size_t size, size_t count)
+{
+    return fread(buf, size, count, (FILE *)file);
+}
+
+/*
+ * Write a local file.
+ */
+int
+sysfile_writeLocal(file_t file, const void *buf, size_t size, size_t count)
+{
+    return fwrite(buf, size, count, (FILE *)file);
+}
+
+/*
+ * Seek in a local file. Return 0 on success, like fseek.
+ */
+int
+sysfile_seekLocal(file_t file, long offset, int origin)
+{
+    return fseek((FILE *)file, offset, origin);
+}
+
+/*
+ * Close a local file.
+ */
+void
+sysfile_closeLocal(file_t file)
+{
+    fclose((FILE *)file);
+}
+
+/*
+ * Map a local file in memory, read-only.
+ *
+ * Where there is no mmap, the file is read into a block of the memory
+ * stack instead.
+ */
+const void *
+sysfile_mapLocal(const char *name, size_t *size)
+{
+    FILE *fh;
+    struct stat fileStat;
+    void *buf = NULL;
+
+    fh = (FILE *)sysfile_openLocal(name, false);
+    if (!fh)
+    {
+        return NULL;
+    }
+    if (fstat(fileno(fh), &fileStat) != 0 || fileStat.st_size == 0)
+    {
+        fclose(fh);
+        return NULL;
+    }
+    *size = (size_t)fileStat.st_size;
+#ifndef _WIN32
+    buf = mmap(NULL, *size, PROT_READ, MAP_PRIVATE, fileno(fh), 0);
+    if (buf == MAP_FAILED)
+    {
+        buf = NULL;
+    }
+#else
+    buf = sysmem_push(*size);
+    if (buf && fread(buf, *size, 1, fh) != 1)
+    {
+        sysmem_pop(buf);
+        buf = NULL;
+    }
+#endif
+    fclose(fh);  /* the mapping stays valid */
+    return buf;
+}
+
+/*
+ * Unmap a local file.
+ */
+void
+sysfile_unmapLocal(const void *buf, size_t size)
+{
+#ifndef _WIN32
+    munmap((void *)buf, size);
+#else
+    (void)size;
+    sysmem_pop((void *)buf);
+#endif
+}
+
 #ifdef ENABLE_ZIP
 /*
  * Returns 1 if filename has .zip extension.
@@ -14,12 +14,52 @@
 #include "xrick/system/system.h"
 #include "xrick/debug.h"
 
+/*
+ * Memory budget
+ *
+ * 256 KiB hold resources and one game, with a 48 KB rewind buffer. Caches
+ * and draw buffers enabled at build time come on top: shared decoded tiles
+ * and sprites once, draw buffers for the single game (instances get theirs
+ * from the heap, see main_null.c). 540 KiB with the defaults and GFXST.
+ */
+#if defined(ENABLE_TILES_CACHE) && !TILES_CACHE_SLOTS
+#ifdef GFXPC
+#define STACK_TILES_CACHE_SIZE (192*1024)  /* 4 banks of decoded tiles, 3 CGA filters */
+#endif
+#ifdef GFXST
+#define STACK_TILES_CACHE_SIZE (64*1024)   /* 4 banks of decoded tiles */
+#endif
+#else
+#define STACK_TILES_CACHE_SIZE 0           /* on demand slots are part of the game */
+#endif
+
+#if defined(ENABLE_SPRITES_CACHE) && defined(GFXST)
+#define STACK_SPRITES_CACHE_SIZE (160*1024)  /* decoded sprites */
+#elif defined(ENABLE_SPRITES_CACHE)
+#define STACK_SPRITES_CACHE_SIZE ((SPRITES_CACHE_BUDGET + 8) * 1024)  /* pre-shifted sprites, per game */
+#else
+#define STACK_SPRITES_CACHE_SIZE 0
+#endif
+
+#ifdef ENABLE_SAVE_UNDER
+#define STACK_SAVEUNDER_SIZE (8*1024)
+#else
+#define STACK_SAVEUNDER_SIZE 0
+#endif
+
+#ifdef ENABLE_MAP_LAYER
+#define STACK_MAPLAYER_SIZE (52*1024)
+#else
+#define STACK_MAPLAYER_SIZE 0
+#endif
+
 /*
  * local vars
  */
 enum
 {
-    STACK_MAX_SIZE = 256*1024,
+    STACK_MAX_SIZE = 256*1024 + STACK_TILES_CACHE_SIZE + STACK_SPRITES_CACHE_SIZE +
+                     STACK_SAVEUNDER_SIZE + STACK_MAPLAYER_SIZE,
     ALIGNMENT = sizeof(void*)  /* this is more of an educated guess; might want to adjust for your specific architecture */
 };
 static U8 stackBuffer[STACK_MAX_SIZE];
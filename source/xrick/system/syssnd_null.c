@@ -0,0 +1,105 @@
+/*
+ * xrick/system/syssnd_null.c
+ *
+ * Copyright (C) 2008-2014 Pierluigi Vicinanza. All rights reserved.
+ *
+ * The use and distribution terms for this software are contained in the file
+ * named README, which can be found in the root of this distribution. By
+ * using this software in any fashion, you are agreeing to be bound by the
+ * terms of this license.
+ *
+ * You must not remove this notice, or any other, from this software.
+ */
+
+#include "xrick/config.h"
+
+#ifdef ENABLE_SOUND
+
+#include "xrick/system/system.h"
+
+/*
+ * Global variables
+ */
+const U8 syssnd_period = 0xff; /* nothing to mix */
+
+/*
+ * Initialise audio -- there is no audio device
+ */
+bool
+syssnd_init(void)
+{
+    return true;
+}
+
+/*
+ * Shutdown audio
+ */
+void
+syssnd_shutdown(void)
+{
+}
+
+/*
+ * Update audio
+ */
+void
+syssnd_update(void)
+{
+}
+
+/*
+ * Set volume
+ */
+void
+syssnd_vol(S8 d)
+{
+    (void)d;
+}
+
+/*
+ * Toggle mute
+ */
+void
+syssnd_toggleMute(void)
+{
+}
+
+/*
+ * Play a sound
+ */
+void
+syssnd_play(sound_t *sound, S8 loop)
+{
+    (void)sound;
+    (void)loop;
+}
+
+/*
+ * Pause all sounds
+ */
+void
+syssnd_pauseAll(bool pause)
+{
+    (void)pause;
+}
+
+/*
+ * Stop a sound
+ */
+void
+syssnd_stop(sound_t *sound)
+{
+    (void)sound;
+}
+
+/*
+ * Stop all sounds
+ */
+void
+syssnd_stopAll(void)
+{
+}
+
+#endif /* ENABLE_SOUND */
+
+/* eof */
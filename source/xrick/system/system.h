@@ -66,7 +66,9 @@ extern void sys_printf(const char *, ...);
 extern void sys_snprintf(char *, size_t, const char *, ...);
 extern size_t sys_strlen(const char *);
 extern U32 sys_gettime(void);
+extern U32 sys_gettimeUs(void);
 extern void sys_yield(void);
+extern void sys_sleepUntil(U32);
 extern bool sys_cacheData(void);
 extern void sys_uncacheData(void);
 
@@ -86,7 +88,7 @@ extern void sysmem_pop(void *);
 #define SYSVID_WIDTH 320
 #define SYSVID_HEIGHT 200
 
-extern U8 *sysvid_fb;  /* frame buffer */
+#define sysvid_fb (game_ctx->fb)  /* frame buffer, see xrick/context.h */
 
 extern bool sysvid_init(void);
 extern void sysvid_shutdown(void);
@@ -114,6 +116,15 @@ extern off_t sysfile_size(file_t);
 extern int sysfile_read(file_t, void *, size_t, size_t);
 extern void sysfile_close(file_t);
 
+/* local files, i.e. outside of the data archive (e.g. replays) */
+extern file_t sysfile_openLocal(const char *, bool);
+extern int sysfile_readLocal(file_t, void *, size_t, size_t);
+extern int sysfile_writeLocal(file_t, const void *, size_t, size_t);
+extern int sysfile_seekLocal(file_t, long, int);
+extern void sysfile_closeLocal(file_t);
+extern const void *sysfile_mapLocal(const char *, size_t *);
+extern void sysfile_unmapLocal(const void *, size_t);
+
 /*
  * events section
  */
@@ -155,13 +166,28 @@ extern void syssnd_stopAll(void);
 extern int sysarg_args_period;
 extern int sysarg_args_map;
 extern int sysarg_args_submap;
+extern int sysarg_args_turbo;  /* ticks per displayed frame, 0 means no turbo */
 extern int sysarg_args_fullscreen;
 extern int sysarg_args_zoom;
+extern bool sysarg_args_scalex;
+extern int sysarg_args_bpp;  /* 8 or 32, 0 means as the display */
 #ifdef ENABLE_SOUND
 extern bool sysarg_args_nosound;
 extern int sysarg_args_vol;
 #endif /* ENABLE_ SOUND */
 extern const char *sysarg_args_data;
+extern const char *sysarg_args_load;  /* snapshot to start from */
+#ifdef ENABLE_REPLAY
+extern const char *sysarg_args_record;
+extern const char *sysarg_args_replay;
+extern U32 sysarg_args_replayFrom;  /* frame to start playback at, 0 means the start */
+#endif /* ENABLE_REPLAY */
+#ifdef ENABLE_REWIND
+extern U32 sysarg_args_rewind;  /* rewind buffer size, in KB, 0 means none */
+#endif /* ENABLE_REWIND */
+#ifdef ENABLE_PROFILER
+extern const char *sysarg_args_profile;
+#endif /* ENABLE_PROFILER */
 
 extern bool sysarg_init(int, char **);
 
@@ -0,0 +1,340 @@
+/*
+ * xrick/system/system_null.c
+ *
+ * Copyright (C) 2008-2014 Pierluigi Vicinanza. All rights reserved.
+ *
+ * The use and distribution terms for this software are contained in the file
+ * named README, which can be found in the root of this distribution. By
+ * using this software in any fashion, you are agreeing to be bound by the
+ * terms of this license.
+ *
+ * You must not remove this notice, or any other, from this software.
+ */
+
+/* clock_gettime, clock_nanosleep */
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "xrick/system/system.h"
+#include "xrick/system/system_null.h"
+#include "xrick/config.h"
+#include "xrick/context.h"
+#include "xrick/control.h"
+#include "xrick/game.h"
+
+#include <stdarg.h>   /* args */
+#include <stdio.h>    /* printf */
+#include <string.h>   /* strlen */
+#ifdef __WIN32__
+#include <windows.h>
+#else
+#include <time.h>     /* clock_gettime, clock_nanosleep */
+#include <errno.h>    /* EINTR */
+#endif
+
+/*
+ * Global variables
+ */
+U32 sys_frames = 0;  /* all games */
+
+/*
+ * Local variables
+ */
+static THREAD_LOCAL char stringBuffer[2048];  /* games may print from any thread */
+static U32 skippedUs = 0;    /* time skipped by sys_sleepUntil when running fast */
+static U32 skippedMs = 0;
+static U32 skippedRem = 0;   /* in microseconds, not yet accounted for in skippedMs */
+static U32 startTime = 0;    /* wall clock at sys_init */
+
+/*
+ * Return wall clock time in milliseconds
+ */
+static U32
+wallTime(void)
+{
+#ifdef __WIN32__
+    return GetTickCount();
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (U32)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+#endif
+}
+
+/*
+ * Error
+ */
+void
+sys_error(const char *err, ...)
+{
+    va_list argptr;
+
+    va_start(argptr, err);
+    vsnprintf(stringBuffer, sizeof(stringBuffer), err, argptr);
+    va_end(argptr);
+
+    fprintf(stderr, "%s\nError!\n", stringBuffer);
+}
+
+/*
+ * Print a message to standard output
+ */
+void
+sys_printf(const char *msg, ...)
+{
+    va_list argptr;
+
+    va_start(argptr, msg);
+    vsnprintf(stringBuffer, sizeof(stringBuffer), msg, argptr);
+    va_end(argptr);
+
+    printf("%s", stringBuffer);
+}
+
+/*
+ * Print a message to string buffer
+ */
+void
+sys_snprintf(char *buf, size_t size, const char *msg, ...)
+{
+    va_list argptr;
+
+    va_start(argptr, msg);
+    vsnprintf(buf, size, msg, argptr);
+    va_end(argptr);
+}
+
+/*
+ * Returns string length
+ */
+size_t
+sys_strlen(const char * str)
+{
+    return strlen(str);
+}
+
+/*
+ * Return wall clock time in microseconds (wraps around)
+ */
+static U32
+wallTimeUs(void)
+{
+#ifdef __WIN32__
+    LARGE_INTEGER frequency, counter;
+
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (U32)((counter.QuadPart / frequency.QuadPart) * 1000000 +
+                 (counter.QuadPart % frequency.QuadPart) * 1000000 / frequency.QuadPart);
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (U32)ts.tv_sec * 1000000 + (U32)(ts.tv_nsec / 1000);
+#endif
+}
+
+/*
+ * Return number of milliseconds elapsed since first call
+ *
+ * When running fast, this clock also jumps forward every time
+ * sys_sleepUntil is called (see below).
+ */
+U32
+sys_gettime(void)
+{
+    return wallTime() - startTime + skippedMs;
+}
+
+/*
+ * Return number of microseconds elapsed since first call (wraps around)
+ *
+ * Same as sys_gettime: time measured between two calls to sys_sleepUntil
+ * is always wall clock time.
+ */
+U32
+sys_gettimeUs(void)
+{
+    return wallTimeUs() + skippedUs;
+}
+
+/*
+ * Yield execution to another thread
+ */
+void
+sys_yield(void)
+{
+    if (sysarg_args_fast)
+    {
+        return;
+    }
+#ifdef __WIN32__
+    Sleep(1);
+#else
+    {
+        struct timespec ts = { 0, 1000000 };
+        nanosleep(&ts, NULL);
+    }
+#endif
+}
+
+/*
+ * Sleep until sys_gettimeUs reaches deadline
+ *
+ * When running fast, do not sleep but move the clock forward to the
+ * deadline instead, so that frames are run back to back while the game
+ * still sees them paced by game_period.
+ */
+void
+sys_sleepUntil(U32 deadline)
+{
+    S32 delay = (S32)(deadline - sys_gettimeUs());
+
+    if (delay <= 0)
+    {
+        return;
+    }
+    if (sysarg_args_fast)
+    {
+        skippedUs += delay;
+        skippedRem += delay;
+        skippedMs += skippedRem / 1000;
+        skippedRem %= 1000;
+        return;
+    }
+#ifdef __WIN32__
+    Sleep(delay / 1000);
+#elif defined(TIMER_ABSTIME)
+    {
+        struct timespec ts;
+
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        ts.tv_nsec += (long)(delay % 1000000) * 1000;
+        ts.tv_sec += delay / 1000000 + ts.tv_nsec / 1000000000;
+        ts.tv_nsec %= 1000000000;
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+        {
+            /* interrupted by a signal: sleep again until the same deadline */
+        }
+    }
+#else
+    {
+        struct timespec ts;
+
+        ts.tv_sec = delay / 1000000;
+        ts.tv_nsec = (long)(delay % 1000000) * 1000;
+        nanosleep(&ts, NULL);
+    }
+#endif
+}
+
+/*
+ * Called once per frame by the events section
+ *
+ * Frames are counted per game (game_frames), so that every instance
+ * exits after the same number of frames, the last one being the frame the
+ * game exits on.
+ */
+void
+sys_tick(void)
+{
+    if (control_test(Control_EXIT))
+    {
+        return;  /* the game is leaving, this is not a frame */
+    }
+#ifdef ENABLE_REWIND
+    /* hold rewind during the last second */
+    if (sysarg_args_rewind && sysarg_args_frames &&
+        game_frames + 1000 / game_period >= sysarg_args_frames)
+    {
+        control_set(Control_REWIND);
+    }
+#endif /* ENABLE_REWIND */
+    if (sysarg_args_frames && game_frames + 1 >= sysarg_args_frames)
+    {
+        if (sysarg_args_save)
+        {
+            game_saveSnapshot(sysarg_args_save);
+        }
+        control_set(Control_EXIT);
+    }
+}
+
+/*
+ * Initialize system
+ */
+bool
+sys_init(int argc, char **argv)
+{
+    if (!sysarg_init(argc, argv))
+    {
+        return false;
+    }
+    if (!sysmem_init())
+    {
+        return false;
+    }
+    if (!sysvid_init())
+    {
+        return false;
+    }
+#ifdef ENABLE_SOUND
+    if (!sysarg_args_nosound && !syssnd_init())
+    {
+        return false;
+    }
+#endif
+    if (!sysfile_setRootPath(sysarg_args_data? sysarg_args_data : sysfile_defaultPath))
+    {
+        return false;
+    }
+    startTime = wallTime();
+    return true;
+}
+
+/*
+ * Shutdown system
+ */
+void
+sys_shutdown(void)
+{
+    U32 elapsed = wallTime() - startTime;
+
+    if (sys_frames)
+    {
+        sys_printf("xrick/headless: %u frames in %u ms", sys_frames, elapsed);
+        if (elapsed)
+        {
+            sys_printf(" (%.2f frames/s)", sys_frames * 1000.0 / elapsed);
+        }
+        sys_printf("\n");
+    }
+
+    sysfile_clearRootPath();
+#ifdef ENABLE_SOUND
+    syssnd_shutdown();
+#endif
+    sysvid_shutdown();
+    sysmem_shutdown();
+}
+
+/*
+ * Preload data before entering main loop
+ */
+bool
+sys_cacheData(void)
+{
+    return true;
+}
+
+/*
+ * Clear preloaded data before shutdown
+ */
+void
+sys_uncacheData(void)
+{
+}
+
+/* eof */
@@ -0,0 +1,43 @@
+/*
+ * xrick/system/system_null.h
+ *
+ * Copyright (C) 2008-2014 Pierluigi Vicinanza. All rights reserved.
+ *
+ * The use and distribution terms for this software are contained in the file
+ * named README, which can be found in the root of this distribution. By
+ * using this software in any fashion, you are agreeing to be bound by the
+ * terms of this license.
+ *
+ * You must not remove this notice, or any other, from this software.
+ */
+
+#ifndef _SYSTEM_NULL_H
+#define _SYSTEM_NULL_H
+
+#include "xrick/system/basic_types.h"
+
+/*
+ * The null system is a headless back-end: no window, no sound, no input.
+ * It is meant to measure how fast the simulation and the rendering into
+ * the frame buffer can run, without any platform overhead.
+ */
+
+/*
+ * args section
+ */
+extern bool sysarg_args_fast;   /* ignore game_period, run frames back to back */
+extern U32 sysarg_args_frames;  /* exit after that many frames, 0 means never */
+extern U32 sysarg_args_instances;  /* number of games to run side by side */
+extern const char *sysarg_args_save;  /* snapshot to write after sysarg_args_frames */
+extern bool sysarg_args_bench;  /* run micro-benchmarks instead of a game */
+
+/*
+ * main section
+ */
+extern U32 sys_frames;          /* number of frames produced by all games */
+
+extern void sys_tick(void);
+
+#endif /* ndef _SYSTEM_NULL_H */
+
+/* eof */
@@ -123,6 +123,15 @@ U32 sys_gettime(void)
     return (U32)((ticks * 1000) / HZ);
 }
 
+/*
+* Return number of microseconds elapsed since first call (wraps around)
+*/
+U32 sys_gettimeUs(void)
+{
+    long ticks = *(rb->current_tick);
+    return (U32)(ticks * (1000000 / HZ));
+}
+
 /*
 * Yield execution to another thread
 */
@@ -131,6 +140,26 @@ void sys_yield(void)
     rb->yield();
 }
 
+/*
+* Sleep until sys_gettimeUs reaches deadline
+*/
+void sys_sleepUntil(U32 deadline)
+{
+    S32 delay = (S32)(deadline - sys_gettimeUs());
+    if (delay <= 0)
+    {
+        return;
+    }
+    if (delay < 1000000 / HZ)
+    {
+        rb->yield();
+    }
+    else
+    {
+        rb->sleep(delay / (1000000 / HZ));
+    }
+}
+
 /*
 * Initialize system
 */
@@ -13,6 +13,11 @@
  * You must not remove this notice, or any other, from this software.
  */
 
+/* clock_gettime, clock_nanosleep */
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200112L
+#endif
+
 #include "xrick/system/system.h"
 #include "xrick/config.h"
 #ifdef ENABLE_SOUND
@@ -25,8 +30,11 @@
 #include <stdio.h>    /* printf */
 #include <stdlib.h>
 #include <string.h>   /* strlen */
-#ifdef _MSC_VER
+#ifdef __WIN32__
 #include <windows.h>
+#else
+#include <time.h>     /* clock_gettime, clock_nanosleep */
+#include <errno.h>    /* EINTR */
 #endif
 
 /*
@@ -115,6 +123,27 @@ sys_gettime(void)
     return SDL_GetTicks();
 }
 
+/*
+ * Return number of microseconds elapsed since first call (wraps around)
+ */
+U32
+sys_gettimeUs(void)
+{
+#ifdef __WIN32__
+    LARGE_INTEGER frequency, counter;
+
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (U32)((counter.QuadPart / frequency.QuadPart) * 1000000 +
+                 (counter.QuadPart % frequency.QuadPart) * 1000000 / frequency.QuadPart);
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (U32)ts.tv_sec * 1000000 + (U32)(ts.tv_nsec / 1000);
+#endif
+}
+
 /*
  * Yield execution to another thread
  */
@@ -125,6 +154,38 @@ sys_yield(void)
     SDL_Delay(1);
 }
 
+/*
+ * Sleep until sys_gettimeUs reaches deadline
+ */
+void
+sys_sleepUntil(U32 deadline)
+{
+    S32 delay = (S32)(deadline - sys_gettimeUs());
+
+    if (delay <= 0)
+    {
+        return;
+    }
+#ifdef __WIN32__
+    SDL_Delay(delay / 1000);
+#elif defined(TIMER_ABSTIME)
+    {
+        struct timespec ts;
+
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        ts.tv_nsec += (long)(delay % 1000000) * 1000;
+        ts.tv_sec += delay / 1000000 + ts.tv_nsec / 1000000000;
+        ts.tv_nsec %= 1000000000;
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+        {
+            /* interrupted by a signal: sleep again until the same deadline */
+        }
+    }
+#else
+    SDL_Delay(delay / 1000);
+#endif
+}
+
 /*
  * Initialize system
  */
@@ -0,0 +1,121 @@
+/*
+ * xrick/system/sysvid_null.c
+ *
+ * Copyright (C) 2008-2014 Pierluigi Vicinanza. All rights reserved.
+ *
+ * The use and distribution terms for this software are contained in the file
+ * named README, which can be found in the root of this distribution. By
+ * using this software in any fashion, you are agreeing to be bound by the
+ * terms of this license.
+ *
+ * You must not remove this notice, or any other, from this software.
+ */
+
+#include "xrick/system/system.h"
+#include "xrick/context.h"
+#include "xrick/data/img.h"
+#include "xrick/debug.h"
+
+#include <string.h> /* memset */
+#include <stdlib.h> /* malloc */
+
+/*
+ * Local variables
+ */
+static bool isVideoInitialised = false;
+
+/*
+ * Set palette -- nothing to display
+ */
+void
+sysvid_setPalette(img_color_t *pal, U16 n)
+{
+    (void)pal;
+    (void)n;
+}
+
+/*
+ * Set game palette -- nothing to display
+ */
+void
+sysvid_setGamePalette(void)
+{
+}
+
+/*
+ * Initialise video
+ */
+bool
+sysvid_init(void)
+{
+    if (isVideoInitialised)
+    {
+        return true;
+    }
+
+    sysvid_fb = malloc(SYSVID_WIDTH * SYSVID_HEIGHT);
+    if (!sysvid_fb)
+    {
+        sys_error("(video) sysvid_fb malloc failed");
+        return false;
+    }
+    memset(sysvid_fb, 0, SYSVID_WIDTH * SYSVID_HEIGHT);
+
+    isVideoInitialised = true;
+    IFDEBUG_VIDEO(sys_printf("xrick/video: ready (null)\n"););
+    return true;
+}
+
+/*
+ * Shutdown video
+ */
+void
+sysvid_shutdown(void)
+{
+    if (!isVideoInitialised)
+    {
+        return;
+    }
+
+    free(sysvid_fb);
+    sysvid_fb = NULL;
+    isVideoInitialised = false;
+    IFDEBUG_VIDEO(sys_printf("xrick/video: stop\n"););
+}
+
+/*
+ * Update screen -- frame buffer content goes nowhere
+ */
+void
+sysvid_update(const rect_t *rects)
+{
+    (void)rects;
+}
+
+/*
+ * Clear screen
+ */
+void
+sysvid_clear(void)
+{
+    memset(sysvid_fb, 0, SYSVID_WIDTH * SYSVID_HEIGHT);
+}
+
+/*
+ * Zoom -- nothing to display
+ */
+void
+sysvid_zoom(S8 z)
+{
+    (void)z;
+}
+
+/*
+ * Toggle fullscreen -- nothing to display
+ */
+void
+sysvid_toggleFullscreen(void)
+{
+}
+
+/* eof */
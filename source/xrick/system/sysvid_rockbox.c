@@ -33,11 +33,6 @@
 #include "plugin.h"
 #include "lib/helper.h"
 
-/*
- * Global variables
- */
-U8 *sysvid_fb = NULL; /* xRick generic 320x200 8bpp frame buffer */
-
 /*
  * Local variables
  */
@@ -19,15 +19,22 @@
 #include "xrick/data/img.h"
 #include "xrick/debug.h"
 #include "xrick/system/system.h"
+#include "xrick/system/scalex_sdl.h"
 
-#include <string.h> /* memset */
+#include <string.h> /* memcpy, memset */
 #include <stdlib.h> /* malloc */
 #include <SDL.h>
-
-/*
- * Global variables
- */
-U8 *sysvid_fb; /* frame buffer */
+#ifdef ENABLE_PRESENTER
+#include <SDL_thread.h>
+#endif /* ENABLE_PRESENTER */
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
 
 /*
  * Local variables
@@ -40,9 +47,38 @@ static bool isVideoInitialised = false;
 static U8 zoom = SYSVID_ZOOM; /* actual zoom level */
 static U8 szoom = 0;  /* saved zoom level */
 static U8 fszoom = 0;  /* fullscreen zoom level */
+static U32 zoomLut[256];  /* pixel value in every byte, to widen by 2 to 4 */
+static U8 bpp = 8;  /* screen bits per pixel, 8 or 32 */
+static U32 rgbLut[256];  /* palette as 32 bits screen pixels */
+
+#ifdef ENABLE_PRESENTER
+/*
+ * The game draws into one frame buffer while the presenter thread scales
+ * the other one to the screen. At the end of a frame they swap: the
+ * presenter gets the buffer just drawn, with a copy of its dirty rects,
+ * and the game gets the other one back once these rects are copied into
+ * it, so that it holds the same picture.
+ */
+#define SYSVID_PRESENT_RECTS 64  /* per frame, more and the whole screen goes */
+
+static U8 *frameBuffers[2];
+static SDL_Thread *presenter = NULL;
+static SDL_sem *presentStart;  /* posted by the game: a frame is handed over */
+static SDL_sem *presentDone;   /* posted by the presenter: it is idle */
+static const U8 *presentFb;
+static rect_t presentRects[SYSVID_PRESENT_RECTS];
+static bool presentFailed = false;
+static bool presentQuit = false;
+#endif /* ENABLE_PRESENTER */
 
 #include "xrick/system/sdl_icon.e"
 
+static bool updateScreen(const U8 *, const rect_t *);
+#ifdef ENABLE_PRESENTER
+static int presenterRun(void *);
+static void presenterWait(void);
+#endif /* ENABLE_PRESENTER */
+
 /*
  * Initialize screen
  */
@@ -51,12 +87,32 @@ static SDL_Surface *initScreen(U16 w, U16 h, U8 bpp, U32 flags)
     return SDL_SetVideoMode(w, h, bpp, flags);
 }
 
+/*
+ * Build the 32 bits palette lookup table, in the screen pixel format
+ */
+static void buildRgbLut(void)
+{
+    U16 i;
+
+    for (i = 0; i < 256; i++)
+    {
+        rgbLut[i] = SDL_MapRGB(screen->format, palette[i].r, palette[i].g, palette[i].b);
+    }
+}
+
 /*
  *
  */
 static void sysvid_restorePalette()
 {
-    SDL_SetColors(screen, (SDL_Color *)&palette, 0, 256);
+    if (bpp == 32)
+    {
+        buildRgbLut();
+    }
+    else
+    {
+        SDL_SetColors(screen, (SDL_Color *)&palette, 0, 256);
+    }
 }
 
 /*
@@ -66,13 +122,25 @@ void sysvid_setPalette(img_color_t *pal, U16 n)
 {
     U16 i;
 
+#ifdef ENABLE_PRESENTER
+    presenterWait();
+#endif /* ENABLE_PRESENTER */
     for (i = 0; i < n; i++)
     {
         palette[i].r = pal[i].r;
         palette[i].g = pal[i].g;
         palette[i].b = pal[i].b;
     }
-    SDL_SetColors(screen, (SDL_Color *)&palette, 0, n);
+    /* at 32 bpp, only the lookup table changes: the screen gets the new
+       colours on its next update */
+    if (bpp == 32)
+    {
+        buildRgbLut();
+    }
+    else
+    {
+        SDL_SetColors(screen, (SDL_Color *)&palette, 0, n);
+    }
 }
 
 /*
@@ -139,8 +207,10 @@ bool
 sysvid_init(void)
 {
     SDL_Surface *icon;
+    const SDL_VideoInfo *info;
     U8 transpIndex, transpRed, transpGreen, transpBlue;
     U32 colorKey;
+    U16 i;
     /*
     U8 *mask;
     U32 len, i;
@@ -199,8 +269,18 @@ sysvid_init(void)
 
     SDL_WM_SetIcon(icon, NULL);
 
-    /* video modes and screen */
-    videoFlags = SDL_HWSURFACE|SDL_HWPALETTE;
+    /* video modes and screen: palettized unless asked for, or the display
+       is, 32 bpp */
+    if (sysarg_args_bpp)
+    {
+        bpp = sysarg_args_bpp;
+    }
+    else
+    {
+        info = SDL_GetVideoInfo();
+        bpp = (info && info->vfmt->BitsPerPixel == 32) ? 32 : 8;
+    }
+    videoFlags = (bpp == 8) ? SDL_HWSURFACE|SDL_HWPALETTE : SDL_HWSURFACE;
     if (!sysvid_chkvm()) /* check video modes */
     {
         SDL_Quit();
@@ -216,11 +296,25 @@ sysvid_init(void)
         szoom = zoom;
         zoom = fszoom;
     }
-    screen = initScreen(SYSVID_WIDTH * zoom, SYSVID_HEIGHT * zoom, 8, videoFlags);
+    screen = initScreen(SYSVID_WIDTH * zoom, SYSVID_HEIGHT * zoom, bpp, videoFlags);
 
     /*
     * create v_ frame buffer
     */
+#ifdef ENABLE_PRESENTER
+    frameBuffers[0] = malloc(SYSVID_WIDTH * SYSVID_HEIGHT);
+    frameBuffers[1] = malloc(SYSVID_WIDTH * SYSVID_HEIGHT);
+    if (!frameBuffers[0] || !frameBuffers[1])
+    {
+        sys_error("(video) sysvid_fb malloc failed");
+        free(frameBuffers[0]);
+        free(frameBuffers[1]);
+        SDL_Quit();
+        return false;
+    }
+    memset(frameBuffers[1], 0, SYSVID_WIDTH * SYSVID_HEIGHT);
+    sysvid_fb = frameBuffers[0];
+#else
     sysvid_fb = malloc(SYSVID_WIDTH * SYSVID_HEIGHT);
     if (!sysvid_fb)
     {
@@ -228,6 +322,29 @@ sysvid_init(void)
         SDL_Quit();
         return false;
     }
+#endif /* ENABLE_PRESENTER */
+
+    for (i = 0; i < 256; i++)
+    {
+        zoomLut[i] = i * 0x01010101;
+    }
+
+    if (sysarg_args_scalex)
+    {
+        scalex_init();
+    }
+
+#ifdef ENABLE_PRESENTER
+    /* without a presenter thread, frames are presented by the game */
+    presentQuit = false;
+    presentStart = SDL_CreateSemaphore(0);
+    presentDone = SDL_CreateSemaphore(1);
+    if (presentStart && presentDone)
+    {
+        presenter = SDL_CreateThread(presenterRun, NULL);
+    }
+    IFDEBUG_VIDEO(sys_printf("xrick/video: %s presenter thread\n", presenter ? "with" : "without"););
+#endif /* ENABLE_PRESENTER */
 
     isVideoInitialised = true;
     IFDEBUG_VIDEO(sys_printf("xrick/video: ready\n"););
@@ -245,56 +362,338 @@ sysvid_shutdown(void)
         return;
     }
 
+#ifdef ENABLE_PRESENTER
+    if (presenter)
+    {
+        presenterWait();
+        presentQuit = true;
+        SDL_SemPost(presentStart);
+        SDL_WaitThread(presenter, NULL);
+        presenter = NULL;
+    }
+    if (presentStart)
+    {
+        SDL_DestroySemaphore(presentStart);
+    }
+    if (presentDone)
+    {
+        SDL_DestroySemaphore(presentDone);
+    }
+#endif /* ENABLE_PRESENTER */
+    if (sysarg_args_scalex)
+    {
+        scalex_shutdown();
+    }
+#ifdef ENABLE_PRESENTER
+    free(frameBuffers[0]);
+    free(frameBuffers[1]);
+#else
     free(sysvid_fb);
+#endif /* ENABLE_PRESENTER */
     SDL_Quit();
     isVideoInitialised = false;
     IFDEBUG_VIDEO(sys_printf("xrick/video: stop\n"););
 }
 
+/*
+ * Widen n frame buffer pixels into zoom screen pixels each
+ */
+static void
+zoomRow(U8 *q, const U8 *p, U16 n)
+{
+    U16 x = 0;
+    U8 z;
+
+    switch (zoom)
+    {
+    case 1:
+        memcpy(q, p, n);
+        break;
+
+    case 2:
+#if defined(__SSE2__)
+        for (; x + 16 <= n; x += 16)
+        {
+            __m128i v = _mm_loadu_si128((const __m128i *)(p + x));
+            _mm_storeu_si128((__m128i *)(q + x * 2), _mm_unpacklo_epi8(v, v));
+            _mm_storeu_si128((__m128i *)(q + x * 2 + 16), _mm_unpackhi_epi8(v, v));
+        }
+#elif defined(__ARM_NEON)
+        for (; x + 16 <= n; x += 16)
+        {
+            uint8x16x2_t w;
+            w.val[0] = w.val[1] = vld1q_u8(p + x);
+            vst2q_u8(q + x * 2, w);
+        }
+#endif
+        for (; x < n; x++)
+        {
+            memcpy(q + x * 2, &zoomLut[p[x]], 2);
+        }
+        break;
+
+    case 3:
+#if defined(__SSSE3__)
+        for (; x + 16 <= n; x += 16)
+        {
+            __m128i v = _mm_loadu_si128((const __m128i *)(p + x));
+            _mm_storeu_si128((__m128i *)(q + x * 3), _mm_shuffle_epi8(v,
+                _mm_setr_epi8(0, 0, 0, 1, 1, 1, 2, 2, 2, 3, 3, 3, 4, 4, 4, 5)));
+            _mm_storeu_si128((__m128i *)(q + x * 3 + 16), _mm_shuffle_epi8(v,
+                _mm_setr_epi8(5, 5, 6, 6, 6, 7, 7, 7, 8, 8, 8, 9, 9, 9, 10, 10)));
+            _mm_storeu_si128((__m128i *)(q + x * 3 + 32), _mm_shuffle_epi8(v,
+                _mm_setr_epi8(10, 11, 11, 11, 12, 12, 12, 13, 13, 13, 14, 14, 14, 15, 15, 15)));
+        }
+#elif defined(__ARM_NEON)
+        for (; x + 16 <= n; x += 16)
+        {
+            uint8x16x3_t w;
+            w.val[0] = w.val[1] = w.val[2] = vld1q_u8(p + x);
+            vst3q_u8(q + x * 3, w);
+        }
+#endif
+        for (; x + 1 < n; x++)  /* 4 bytes stores, the next pixel overwrites one */
+        {
+            memcpy(q + x * 3, &zoomLut[p[x]], 4);
+        }
+        if (x < n)
+        {
+            memcpy(q + x * 3, &zoomLut[p[x]], 3);
+        }
+        break;
+
+    case 4:
+#if defined(__SSE2__)
+        for (; x + 16 <= n; x += 16)
+        {
+            __m128i v = _mm_loadu_si128((const __m128i *)(p + x));
+            __m128i lo = _mm_unpacklo_epi8(v, v);
+            __m128i hi = _mm_unpackhi_epi8(v, v);
+            _mm_storeu_si128((__m128i *)(q + x * 4), _mm_unpacklo_epi16(lo, lo));
+            _mm_storeu_si128((__m128i *)(q + x * 4 + 16), _mm_unpackhi_epi16(lo, lo));
+            _mm_storeu_si128((__m128i *)(q + x * 4 + 32), _mm_unpacklo_epi16(hi, hi));
+            _mm_storeu_si128((__m128i *)(q + x * 4 + 48), _mm_unpackhi_epi16(hi, hi));
+        }
+#elif defined(__ARM_NEON)
+        for (; x + 16 <= n; x += 16)
+        {
+            uint8x16x4_t w;
+            w.val[0] = w.val[1] = w.val[2] = w.val[3] = vld1q_u8(p + x);
+            vst4q_u8(q + x * 4, w);
+        }
+#endif
+        for (; x < n; x++)
+        {
+            memcpy(q + x * 4, &zoomLut[p[x]], 4);
+        }
+        break;
+
+    default:  /* fullscreen on large displays */
+        for (; x < n; x++)
+        {
+            for (z = 0; z < zoom; z++)
+            {
+                *q++ = p[x];
+            }
+        }
+        break;
+    }
+}
+
+/*
+ * Convert n frame buffer pixels through the palette lookup table, into
+ * zoom 32 bits screen pixels each
+ */
+static void
+zoomRow32(U32 *q, const U8 *p, U16 n)
+{
+    U16 x;
+    U8 z;
+
+    switch (zoom)
+    {
+    case 1:
+        for (x = 0; x < n; x++)
+        {
+            q[x] = rgbLut[p[x]];
+        }
+        break;
+
+    case 2:
+        for (x = 0; x < n; x++)
+        {
+            q[x * 2] = q[x * 2 + 1] = rgbLut[p[x]];
+        }
+        break;
+
+    default:
+        for (x = 0; x < n; x++)
+        {
+            U32 c = rgbLut[p[x]];
+            for (z = 0; z < zoom; z++)
+            {
+                *q++ = c;
+            }
+        }
+        break;
+    }
+}
+
 /*
  * Update screen
- * NOTE errors processing ?
  */
 void
 sysvid_update(const rect_t *rects)
 {
-  static SDL_Rect area;
-  U16 x, y, xz, yz;
-  U8 *p, *q, *p0, *q0;
+#ifdef ENABLE_PRESENTER
+  const rect_t *r;
+  U8 *front, *back;
+  U16 n, y;
 
   if (rects == NULL)
     return;
 
+  if (!presenter) {
+    if (!updateScreen(sysvid_fb, rects))
+      control_set(Control_EXIT);
+    return;
+  }
+
+  SDL_SemWait(presentDone);  /* presenter idle, done with the back buffer */
+  if (presentFailed) {
+    control_set(Control_EXIT);
+    SDL_SemPost(presentDone);
+    return;
+  }
+
+  /* rects are owned by the game, hand a copy over */
+  n = 0;
+  for (r = rects; r; r = r->next) {
+    if (n == SYSVID_PRESENT_RECTS) {
+      presentRects[0] = draw_SCREENRECT;
+      n = 1;
+      break;
+    }
+    presentRects[n++] = *r;
+  }
+  for (y = 0; y < n; y++)
+    presentRects[y].next = (y + 1 < n) ? &presentRects[y + 1] : NULL;
+
+  front = sysvid_fb;
+  back = (front == frameBuffers[0]) ? frameBuffers[1] : frameBuffers[0];
+  presentFb = front;
+  SDL_SemPost(presentStart);
+
+  /* replay this frame into the back buffer, which the game draws next */
+  for (r = presentRects; r; r = r->next)
+    for (y = r->y; y < r->y + r->height; y++)
+      memcpy(back + r->x + y * SYSVID_WIDTH, front + r->x + y * SYSVID_WIDTH, r->width);
+  sysvid_fb = back;
+#else
+  if (!updateScreen(sysvid_fb, rects))
+    control_set(Control_EXIT);
+#endif /* ENABLE_PRESENTER */
+}
+
+#ifdef ENABLE_PRESENTER
+/*
+ * Presenter thread: present frames as the game hands them over
+ */
+static int
+presenterRun(void *arg)
+{
+  (void)arg;
+
+  while (1) {
+    SDL_SemWait(presentStart);
+    if (presentQuit)
+      break;
+    if (!updateScreen(presentFb, presentRects))
+      presentFailed = true;
+    SDL_SemPost(presentDone);
+  }
+  return 0;
+}
+
+/*
+ * Wait for the presenter to be done with the screen
+ */
+static void
+presenterWait(void)
+{
+  if (presenter) {
+    SDL_SemWait(presentDone);
+    SDL_SemPost(presentDone);
+  }
+}
+#endif /* ENABLE_PRESENTER */
+
+/*
+ * Scale and convert frame buffer rects to the screen
+ * NOTE errors processing ?
+ */
+static bool
+updateScreen(const U8 *fb, const rect_t *rects)
+{
+  static SDL_Rect area;
+  rect_t r;
+  U16 y, yz;
+  U8 *q0;
+  const U8 *p0;
+
+  if (rects == NULL)
+    return true;
+
   if (SDL_LockSurface(screen) == -1)
   {
     sys_error("(video): SDL_LockSurface failed");
-    control_set(Control_EXIT);
-    return;
+    return false;
   }
 
   while (rects) {
-    p0 = sysvid_fb;
-    p0 += rects->x + rects->y * SYSVID_WIDTH;
-    q0 = (U8 *)screen->pixels;
-    q0 += (rects->x + rects->y * SYSVID_WIDTH * zoom) * zoom;
+    r = *rects;
 
-    for (y = rects->y; y < rects->y + rects->height; y++) {
-      for (yz = 0; yz < zoom; yz++) {
-    p = p0;
-    q = q0;
-    for (x = rects->x; x < rects->x + rects->width; x++) {
-      for (xz = 0; xz < zoom; xz++) {
-        *q = *p;
-        q++;
+    if (sysarg_args_scalex && scalex_supports(zoom)) {
+      /* r grows by the pixels whose neighbours changed */
+      scalex_rect((U8 *)screen->pixels, screen->pitch, fb, &r, zoom,
+          (bpp == 32) ? rgbLut : NULL);
+    }
+    else if (bpp == 32) {
+      /* convert and widen each row once, then copy it for the vertical replicas */
+      p0 = fb;
+      p0 += r.x + r.y * SYSVID_WIDTH;
+      q0 = (U8 *)screen->pixels;
+      q0 += r.y * zoom * screen->pitch + r.x * zoom * 4;
+
+      for (y = r.y; y < r.y + r.height; y++) {
+    zoomRow32((U32 *)q0, p0, r.width);
+    for (yz = 1; yz < zoom; yz++)
+      memcpy(q0 + yz * screen->pitch, q0, r.width * zoom * 4);
+    q0 += zoom * screen->pitch;
+    p0 += SYSVID_WIDTH;
       }
-      p++;
     }
-    q0 += SYSVID_WIDTH * zoom;
+    else {
+      p0 = fb;
+      p0 += r.x + r.y * SYSVID_WIDTH;
+      q0 = (U8 *)screen->pixels;
+      q0 += (r.x + r.y * SYSVID_WIDTH * zoom) * zoom;
+
+      /* widen each row once, then copy it for the vertical replicas */
+      for (y = r.y; y < r.y + r.height; y++) {
+    zoomRow(q0, p0, r.width);
+    for (yz = 1; yz < zoom; yz++)
+      memcpy(q0 + yz * SYSVID_WIDTH * zoom, q0, r.width * zoom);
+    q0 += SYSVID_WIDTH * zoom * zoom;
+    p0 += SYSVID_WIDTH;
       }
-      p0 += SYSVID_WIDTH;
     }
 
-    IFDEBUG_VIDEO2(
+    IFDEBUG_VIDEO2({
+    U16 x;
+    U16 xz;
+    U8 *p;
+
     for (y = rects->y; y < rects->y + rects->height; y++)
       for (yz = 0; yz < zoom; yz++) {
     p = (U8 *)screen->pixels + rects->x * zoom + (y * zoom + yz) * SYSVID_WIDTH * zoom;
@@ -308,18 +707,19 @@ sysvid_update(const rect_t *rects)
     *p = 0x01;
     *(p + ((rects->height * zoom - 1) * zoom) * SYSVID_WIDTH) = 0x01;
       }
-    );
+    });
 
-    area.x = rects->x * zoom;
-    area.y = rects->y * zoom;
-    area.h = rects->height * zoom;
-    area.w = rects->width * zoom;
+    area.x = r.x * zoom;
+    area.y = r.y * zoom;
+    area.h = r.height * zoom;
+    area.w = r.width * zoom;
     SDL_UpdateRects(screen, 1, &area);
 
     rects = rects->next;
   }
 
   SDL_UnlockSurface(screen);
+  return true;
 }
 
 
@@ -343,6 +743,9 @@ sysvid_zoom(S8 z)
   if (!(videoFlags & SDL_FULLSCREEN) &&
       ((z < 0 && zoom > 1) ||
        (z > 0 && zoom < SYSVID_MAXZOOM))) {
+#ifdef ENABLE_PRESENTER
+    presenterWait();
+#endif /* ENABLE_PRESENTER */
     zoom += z;
     screen = initScreen(SYSVID_WIDTH * zoom,
             SYSVID_HEIGHT * zoom,
@@ -358,6 +761,9 @@ sysvid_zoom(S8 z)
 void
 sysvid_toggleFullscreen(void)
 {
+#ifdef ENABLE_PRESENTER
+  presenterWait();
+#endif /* ENABLE_PRESENTER */
   videoFlags ^= SDL_FULLSCREEN;
 
   if (videoFlags & SDL_FULLSCREEN) {  /* go fullscreen */
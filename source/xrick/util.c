@@ -111,55 +111,55 @@ u_envtest(S16 x, S16 y, bool crawl, U8 *rc0, U8 *rc1)
 
   if (xx & 0x07) {  /* tiles columns alignment */
     if (crawl) {
-      *rc0 |= (map_eflg[map_map[y][x]] &
+      *rc0 |= (map_eflg[map_tile(y, x)] &
        (MAP_EFLG_VERT|MAP_EFLG_SOLID|MAP_EFLG_SPAD|MAP_EFLG_WAYUP));
-      *rc0 |= (map_eflg[map_map[y][x + 1]] &
+      *rc0 |= (map_eflg[map_tile(y, x + 1)] &
        (MAP_EFLG_VERT|MAP_EFLG_SOLID|MAP_EFLG_SPAD|MAP_EFLG_WAYUP));
-      *rc0 |= (map_eflg[map_map[y][x + 2]] &
+      *rc0 |= (map_eflg[map_tile(y, x + 2)] &
        (MAP_EFLG_VERT|MAP_EFLG_SOLID|MAP_EFLG_SPAD|MAP_EFLG_WAYUP));
       y++;
     }
     do {
-      *rc1 |= (map_eflg[map_map[y][x]] &
+      *rc1 |= (map_eflg[map_tile(y, x)] &
            (MAP_EFLG_SOLID|MAP_EFLG_SPAD|MAP_EFLG_FGND|
         MAP_EFLG_LETHAL|MAP_EFLG_01));
-      *rc1 |= (map_eflg[map_map[y][x + 1]] &
+      *rc1 |= (map_eflg[map_tile(y, x + 1)] &
            (MAP_EFLG_SOLID|MAP_EFLG_SPAD|MAP_EFLG_FGND|
         MAP_EFLG_LETHAL|MAP_EFLG_CLIMB|MAP_EFLG_01));
-      *rc1 |= (map_eflg[map_map[y][x + 2]] &
+      *rc1 |= (map_eflg[map_tile(y, x + 2)] &
            (MAP_EFLG_SOLID|MAP_EFLG_SPAD|MAP_EFLG_FGND|
         MAP_EFLG_LETHAL|MAP_EFLG_01));
       y++;
     } while (--i > 0);
 
-    *rc1 |= (map_eflg[map_map[y][x]] &
+    *rc1 |= (map_eflg[map_tile(y, x)] &
          (MAP_EFLG_SOLID|MAP_EFLG_SPAD|MAP_EFLG_WAYUP|MAP_EFLG_FGND|
           MAP_EFLG_LETHAL|MAP_EFLG_01));
-    *rc1 |= (map_eflg[map_map[y][x + 1]]);
-    *rc1 |= (map_eflg[map_map[y][x + 2]] &
+    *rc1 |= (map_eflg[map_tile(y, x + 1)]);
+    *rc1 |= (map_eflg[map_tile(y, x + 2)] &
          (MAP_EFLG_SOLID|MAP_EFLG_SPAD|MAP_EFLG_WAYUP|MAP_EFLG_FGND|
           MAP_EFLG_LETHAL|MAP_EFLG_01));
   }
   else {
     if (crawl) {
-      *rc0 |= (map_eflg[map_map[y][x]] &
+      *rc0 |= (map_eflg[map_tile(y, x)] &
        (MAP_EFLG_VERT|MAP_EFLG_SOLID|MAP_EFLG_SPAD|MAP_EFLG_WAYUP));
-      *rc0 |= (map_eflg[map_map[y][x + 1]] &
+      *rc0 |= (map_eflg[map_tile(y, x + 1)] &
        (MAP_EFLG_VERT|MAP_EFLG_SOLID|MAP_EFLG_SPAD|MAP_EFLG_WAYUP));
       y++;
     }
     do {
-      *rc1 |= (map_eflg[map_map[y][x]] &
+      *rc1 |= (map_eflg[map_tile(y, x)] &
            (MAP_EFLG_SOLID|MAP_EFLG_SPAD|MAP_EFLG_FGND|
         MAP_EFLG_LETHAL|MAP_EFLG_CLIMB|MAP_EFLG_01));
-      *rc1 |= (map_eflg[map_map[y][x + 1]] &
+      *rc1 |= (map_eflg[map_tile(y, x + 1)] &
            (MAP_EFLG_SOLID|MAP_EFLG_SPAD|MAP_EFLG_FGND|
         MAP_EFLG_LETHAL|MAP_EFLG_CLIMB|MAP_EFLG_01));
       y++;
     } while (--i > 0);
 
-    *rc1 |= (map_eflg[map_map[y][x]]);
-    *rc1 |= (map_eflg[map_map[y][x + 1]]);
+    *rc1 |= (map_eflg[map_tile(y, x)]);
+    *rc1 |= (map_eflg[map_tile(y, x + 1)]);
   }
 
   /*